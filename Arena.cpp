@@ -0,0 +1,220 @@
+//------------------includes--------------------
+#include <atomic>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "Arena.h"
+#include "StackAllocator.h"
+
+//------------------defines--------------------
+#define ARENA_HEADER 64 // start of a chunk, before its first block
+#define LARGE_CLASS -1  // chunk holding one block above ARENA_MAX_BLOCK
+
+//---------------structs---------------------------
+struct ChunkHeader
+{
+    int sizeClass;
+    size_t mapped;             // bytes mapped for the chunk
+    std::atomic<size_t> used;  // bytes handed out to arenas, may run past the chunk's end
+};
+
+//---------------global variables----------------
+// blocks given up by arenas that were destroyed or had too many, taken a whole list at a time
+static std::atomic<void *> arenaShared[ARENA_CLASSES];
+// the chunk of each size class that batches are carved from
+static std::atomic<ChunkHeader *> arenaChunks[ARENA_CLASSES];
+
+//--------------functions-------------------
+static size_t blockSize(int c)
+{
+    return (size_t) ARENA_MIN_BLOCK << c;
+}
+
+static int sizeClass(size_t size)
+{
+    int c = 0;
+    while (blockSize(c) < size)
+    { c++; }
+    return c;
+}
+
+static size_t batchBytes(int c)
+{
+    size_t fit = (ARENA_CHUNK_SIZE - ARENA_HEADER) / blockSize(c);
+    return (fit < ARENA_BATCH_BLOCKS ? fit : ARENA_BATCH_BLOCKS) * blockSize(c);
+}
+
+// map len bytes (a multiple of the page size) starting at an ARENA_CHUNK_SIZE boundary
+static char *mapAligned(size_t len)
+{
+    size_t total = len + ARENA_CHUNK_SIZE;
+    char *raw = (char *) mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                              -1, 0);
+    if (raw == MAP_FAILED)
+    { return nullptr; }
+    char *aligned = (char *) (((uintptr_t) raw + ARENA_CHUNK_SIZE - 1) &
+                              ~(uintptr_t) (ARENA_CHUNK_SIZE - 1));
+    if (aligned > raw)
+    { munmap(raw, aligned - raw); }
+    if (raw + total > aligned + len)
+    { munmap(aligned + len, raw + total - (aligned + len)); }
+    // Thread objects and uthread_alloc blocks stay on the node the stacks are placed on
+    StackAllocator::placeLocal(aligned, len);
+    return aligned;
+}
+
+static ChunkHeader *chunkOf(void *p)
+{
+    return (ChunkHeader *) ((uintptr_t) p & ~(uintptr_t) (ARENA_CHUNK_SIZE - 1));
+}
+
+static void *allocateLarge(size_t size)
+{
+    static const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t len = (ARENA_HEADER + size + page - 1) / page * page;
+    char *chunk = mapAligned(len);
+    if (chunk == nullptr)
+    { return nullptr; }
+    ChunkHeader *header = new(chunk) ChunkHeader();
+    header->sizeClass = LARGE_CLASS;
+    header->mapped = len;
+    return chunk + ARENA_HEADER;
+}
+
+// push the list from head to tail onto the shared list of class c
+static void pushShared(int c, void *head, void *tail)
+{
+    void *shared = arenaShared[c].load();
+    do
+    {
+        *(void **) tail = shared;
+    } while (!arenaShared[c].compare_exchange_weak(shared, head));
+}
+
+// make [begin, end) the arena's batch. A thread may be killed between any two stores, and the
+// destructor releases what lies between _batch and _batchEnd, so the batch is empty meanwhile
+static void publishBatch(char *&batch, char *&batchEnd, char *begin, size_t bytes)
+{
+    batchEnd = nullptr;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    batch = begin;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    batchEnd = begin + bytes;
+}
+
+Arena::Arena() : _free(), _freeCount(), _batch(), _batchEnd()
+{}
+
+Arena::~Arena()
+{
+    for (int c = 0; c < ARENA_CLASSES; ++c)
+    {
+        // the unused part of the batch goes too, so short lived arenas don't leak it
+        for (; _batch[c] < _batchEnd[c]; _batch[c] += blockSize(c))
+        {
+            release(_batch[c]);
+        }
+        void *list = _free[c];
+        if (list == nullptr)
+        { continue; }
+        void *tail = list;
+        while (*(void **) tail != nullptr)
+        { tail = *(void **) tail; }
+        pushShared(c, list, tail);
+    }
+}
+
+void Arena::_spill(int c)
+{
+    void *list = _free[c];
+    // off the arena first: a thread killed before the push leaks the list, instead of
+    // having it pushed a second time by the destructor
+    _free[c] = nullptr;
+    _freeCount[c] = 0;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    void *tail = list;
+    while (*(void **) tail != nullptr)
+    { tail = *(void **) tail; }
+    pushShared(c, list, tail);
+}
+
+bool Arena::_refill(int c)
+{
+    // the exchange takes a whole list, so there is no window for another arena to pop from it
+    void *list = arenaShared[c].exchange(nullptr);
+    if (list != nullptr)
+    {
+        _free[c] = list;
+        return true;
+    }
+    size_t bytes = batchBytes(c);
+    for (;;)
+    {
+        ChunkHeader *chunk = arenaChunks[c].load();
+        if (chunk != nullptr)
+        {
+            size_t offset = chunk->used.fetch_add(bytes);
+            if (offset + bytes <= ARENA_CHUNK_SIZE)
+            {
+                publishBatch(_batch[c], _batchEnd[c], (char *) chunk + offset, bytes);
+                return true;
+            }
+        }
+        char *mapped = mapAligned(ARENA_CHUNK_SIZE);
+        if (mapped == nullptr)
+        { return false; }
+        ChunkHeader *fresh = new(mapped) ChunkHeader();
+        fresh->sizeClass = c;
+        fresh->mapped = ARENA_CHUNK_SIZE;
+        fresh->used.store(ARENA_HEADER + bytes);
+        if (arenaChunks[c].compare_exchange_strong(chunk, fresh))
+        {
+            publishBatch(_batch[c], _batchEnd[c], mapped + ARENA_HEADER, bytes);
+            return true;
+        }
+        munmap(mapped, ARENA_CHUNK_SIZE); // another arena installed a chunk first
+    }
+}
+
+void *Arena::allocate(size_t size)
+{
+    if (size > ARENA_MAX_BLOCK)
+    { return allocateLarge(size); }
+    int c = sizeClass(size);
+    if (_free[c] == nullptr && _batch[c] == _batchEnd[c] && !_refill(c))
+    { return nullptr; }
+    void *p = _free[c];
+    if (p != nullptr)
+    {
+        _free[c] = *(void **) p;
+        if (_freeCount[c] > 0)
+        { _freeCount[c]--; }
+        return p;
+    }
+    p = _batch[c];
+    _batch[c] += blockSize(c);
+    return p;
+}
+
+void Arena::release(void *p)
+{
+    if (p == nullptr)
+    { return; }
+    ChunkHeader *chunk = chunkOf(p);
+    if (chunk->sizeClass == LARGE_CLASS)
+    {
+        munmap(chunk, chunk->mapped);
+        return;
+    }
+    int c = chunk->sizeClass;
+    *(void **) p = _free[c];
+    _free[c] = p;
+    if (++_freeCount[c] > ARENA_FREE_MAX)
+    { _spill(c); }
+}
+
+Arena &schedulerArena()
+{
+    static Arena arena;
+    return arena;
+}
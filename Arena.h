@@ -0,0 +1,121 @@
+//
+// Small-object arenas. Every uthread allocates from and frees to its own arena, which no other
+// uthread and no signal handler touches, so allocation needs neither locks nor signal masking.
+// A thread that frees more than it allocates hands the surplus to shared lists the arenas refill
+// from, so blocks passed from one thread to another are reused.
+// The scheduler allocates from an arena of its own, used only inside library calls and by a
+// switch from the SIGVTALRM handler. The handler never switches inside a library call (the
+// signal is blocked there, or with safe points the switch waits for the call to return), so the
+// arena is never re-entered. It must not be used outside library calls.
+//
+
+#ifndef EX2_ARENA_H
+#define EX2_ARENA_H
+
+//------------------includes--------------------
+#include <cstddef>
+#include <new>
+
+//------------------defines--------------------
+#define ARENA_CLASSES 8           // block sizes 16, 32, ..., 2048 bytes
+#define ARENA_MIN_BLOCK 16
+#define ARENA_MAX_BLOCK (ARENA_MIN_BLOCK << (ARENA_CLASSES - 1))
+#define ARENA_CHUNK_SIZE (1 << 16) // blocks are carved from chunks aligned to their size
+#define ARENA_BATCH_BLOCKS 32      // blocks an arena takes from a chunk at once
+#define ARENA_FREE_MAX (2 * ARENA_BATCH_BLOCKS) // freed blocks an arena keeps of each size
+
+//---------------class---------------------------
+
+class Arena
+{
+private:
+    void *_free[ARENA_CLASSES];      // freed blocks of each size, linked through their first word
+    int _freeCount[ARENA_CLASSES];   // blocks on _free as far as this arena knows, for the limit
+    char *_batch[ARENA_CLASSES];     // blocks of each size taken from a chunk and never used
+    char *_batchEnd[ARENA_CLASSES];
+
+    /**
+     * take a batch of class c blocks from the shared lists or a chunk
+     * @param c
+     * @return false if no memory could be mapped
+     */
+    bool _refill(int c);
+
+    /**
+     * give the class c free list to the shared lists, so blocks freed by a thread that doesn't
+     * allocate them reach the threads that do
+     * @param c
+     */
+    void _spill(int c);
+
+public:
+    Arena();
+
+    /**
+     * blocks cached by the arena are given to the shared lists, for other arenas to use
+     */
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * allocate size bytes, 16 byte aligned. Sizes above ARENA_MAX_BLOCK are mapped on their own
+     * @param size
+     * @return the block, nullptr if no memory could be mapped
+     */
+    void *allocate(size_t size);
+
+    /**
+     * free a block allocated by any arena into this one. Past ARENA_FREE_MAX blocks of a size
+     * they are handed to the shared lists
+     * @param p
+     */
+    void release(void *p);
+};
+
+/**
+ *
+ * @return the arena the scheduler allocates its own objects from
+ */
+Arena &schedulerArena();
+
+/**
+ * An STL allocator drawing from the scheduler's arena, for containers the scheduler only
+ * touches inside library calls or from a switch of the SIGVTALRM handler
+ */
+template<typename T>
+class SchedulerAllocator
+{
+public:
+    typedef T value_type;
+
+    SchedulerAllocator()
+    {}
+
+    template<typename U>
+    SchedulerAllocator(const SchedulerAllocator<U> &)
+    {}
+
+    T *allocate(size_t n)
+    {
+        void *p = schedulerArena().allocate(n * sizeof(T));
+        if (p == nullptr)
+        { throw std::bad_alloc(); }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t)
+    { schedulerArena().release(p); }
+
+    template<typename U>
+    bool operator==(const SchedulerAllocator<U> &) const
+    { return true; }
+
+    template<typename U>
+    bool operator!=(const SchedulerAllocator<U> &) const
+    { return false; }
+};
+
+#endif //EX2_ARENA_H
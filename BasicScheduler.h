@@ -0,0 +1,1875 @@
+//
+// Header only scheduler template, Scheduler (Scheduler.h) is the instantiation the library uses.
+//
+
+#ifndef EX2_BASICSCHEDULER_H
+#define EX2_BASICSCHEDULER_H
+
+//------------------defines--------------------
+#define MAIN_TID 0
+#define NO_THREAD_LEFT "no thread is left to run"
+
+// why the running thread leaves the cpu
+#define SWITCH_PREEMPTED 0
+#define SWITCH_YIELDED 1
+#define SWITCH_BLOCKED 2
+#define SWITCH_SYNCED 3
+#define SWITCH_TERMINATED 4
+#define SWITCH_DEFERRED 5 // a preemption taken at a safe point
+
+#define DEFAULT_GROUP 0
+#define GROUP_STRIDE (1 << 20) // a group's pass advances by GROUP_STRIDE / weight per quantum
+#define NANOS_PER_MICRO 1000
+
+#define BASIC_SCHEDULER_TEMPLATE template<typename ReadySet, typename TimerBackend, int MaxThreads>
+#define BASIC_SCHEDULER BasicScheduler<ReadySet, TimerBackend, MaxThreads>
+
+//------------------includes--------------------
+#include <vector>
+#include <iostream>
+#include <cstring>
+#include "Thread.h"
+#include "Introspect.h"
+#include "Capture.h"
+#include "Idle.h"
+#include "StackAllocator.h"
+#include "SchedulerPolicy.h"
+
+extern sigjmp_buf _env[MAX_THREAD_NUM];
+
+//---------------classes---------------------------
+
+/**
+ * The scheduler, configured at compile time:
+ * ReadySet holds the READY threads, with the std::deque interface (std::deque<Thread *> or
+ * BitmapReadySet), TimerBackend drives the quantums (ItimerBackend or NoTimerBackend) and
+ * MaxThreads bounds the thread ids. Only one scheduler of an instantiation may exist at a time,
+ * and the jump buffers are shared, so MaxThreads is at most MAX_THREAD_NUM. Scheduler is the
+ * instantiation behind the uthreads API; the others are driven through their methods directly.
+ */
+template<typename ReadySet, typename TimerBackend, int MaxThreads>
+class BasicScheduler
+{
+private:
+    static_assert(MaxThreads <= MAX_THREAD_NUM, "thread ids are bounded by MAX_THREAD_NUM");
+
+    //--------------------members--------------------------------
+
+    int _numThreads;
+    int _quantumsPassed; // counter
+    int _quantumUSecs, _quantumSecs;
+    // adaptive quantums: threads that use up their quantum get a longer one, threads that give
+    // the cpu up early a shorter one, within [_minQuantumUsecs, _maxQuantumUsecs]
+    bool _adaptive;
+    int _minQuantumUsecs, _maxQuantumUsecs;
+    bool _lazyTimer; // voluntary switches leave the rest of the quantum to the next thread
+    TimerBackend _timerBackend;
+    // switches don't save the kernel's signal mask, every thread's mask is kept in its Thread
+    // and given to the kernel only where it differs from the mask the kernel has
+    sigset_t _appliedMask;  // the running thread's mask as the kernel has it, SIGVTALRM aside
+    bool _alarmLeftBlocked; // the switch in progress was made in the alarm handler
+    bool _priorityPolicy; // pick the ready thread with the highest effective priority
+    int _idleSpins; // polls before parking when no thread is ready, -1 to never park
+
+    // safe point preemption: the alarm only marks the quantum as over while the running thread
+    // is inside the library, and the switch happens when the library call ends
+    int _maxDeferred;    // quantums a preemption waits for a safe point, -1 when the mode is off
+    int _deferredQuants; // quantums the running thread went on past the end of its quantum
+    volatile sig_atomic_t _libraryDepth;   // library calls the running thread is inside of
+    volatile sig_atomic_t _preemptPending; // the running thread's quantum is over
+    ReadySet _readyFreddie;
+    Thread *_tidMap[MaxThreads];
+    Thread *_currentThread;
+
+    // threads that terminated themselves, freed by the next thread to run once their stack is
+    // no longer in use
+    std::vector<Thread *, SchedulerAllocator<Thread *> > _deadThreads;
+
+    // order in which threads got the cpu, recorded when a log is set
+    int *_switchLog;
+    int _switchLogSize;
+    int _switchCount;
+
+    // a recorded order to follow when picking the next thread
+    const int *_replayLog;
+    int _replayLogSize;
+    int _replayPos;
+
+    // published view of the scheduler, nullptr unless introspection is on
+    SnapshotSeqlock *_snapshot;
+
+    // file the library calls are captured to, nullptr unless capturing
+    CaptureLog *_capture;
+
+    // thread specific storage keys
+    bool _keyUsed[UTHREAD_KEYS_MAX];
+    void (*_keyDestructors[UTHREAD_KEYS_MAX])(void *);
+
+    // thread groups, scheduled by stride: the ready group with the lowest pass runs next
+    int _numGroups;
+    bool _groupUsed[UTHREAD_GROUPS_MAX];
+    int _groupWeight[UTHREAD_GROUPS_MAX];
+    int _groupQuants[UTHREAD_GROUPS_MAX];
+    long _groupRunUsecs[UTHREAD_GROUPS_MAX]; // run time charged to the threads of each group
+    long _groupPass[UTHREAD_GROUPS_MAX];
+    long _groupVirtualTime; // pass of the group picked last, where groups that were idle resume
+    uint64_t _runningSinceNs; // when the running thread got the cpu
+
+    // the scheduler threads of this instantiation enter through, one at a time
+    static BasicScheduler *_instance;
+
+    //--------------------functions------------------------------
+    /**
+     * entry point of every spawned thread: runs its function or closure, then terminates it
+     */
+    static void _threadEntry();
+
+    /**
+     *
+     * @return the next available id for a new thread
+     */
+    int _getNextAvailableID();
+
+    /**
+     *
+     * @return the pointer to the next thread that is ready
+     */
+    Thread *_popNextThread();
+
+    /**
+     *
+     * @return the group with ready threads whose turn it is, -1 if only the default group exists
+     */
+    int _pickGroup();
+
+    /**
+     * make next the running thread: account the new quantum, keep the fpu state, publish and
+     * arm the timer only when the next quantum needs it
+     * @param next
+     * @param reason SWITCH_* for why the current thread leaves the cpu
+     */
+    void _enterThread(Thread *next, int reason);
+
+    /**
+     * the one switch routine: the current thread is saved and next runs. The caller has put the
+     * current thread where it belongs (ready queue, blocked, synced). Returns when the current
+     * thread runs again, or right away if next is the current thread
+     * @param next
+     * @param reason SWITCH_* for why the current thread leaves the cpu
+     */
+    void _switchTo(Thread *next, int reason);
+
+    /**
+     * put the current thread back in the ready queue and switch to the next ready thread
+     * @param reason SWITCH_* for why the current thread leaves the cpu
+     */
+    void _requeueCurrent(int reason);
+
+    /**
+     * give the kernel the signal mask of the thread getting the cpu, blocking and unblocking
+     * only the signals it differs in from the applied mask
+     * @param mask
+     */
+    void _applySigMask(const sigset_t &mask);
+
+    /**
+     *
+     * @return the quantum of the running thread in micro-seconds
+     */
+    int _currentQuantum() const;
+
+    /**
+     * adjust tp's quantum under adaptive quantums
+     * @param tp the thread leaving the cpu
+     * @param exhausted true if its quantum ran out, false if it gave the cpu up
+     */
+    void _adaptQuantum(Thread *tp, bool exhausted);
+
+    /**
+     *
+     * @param quantumUsecs
+     * @return quantumUsecs brought into [_minQuantumUsecs, _maxQuantumUsecs]
+     */
+    int _clampQuantum(int quantumUsecs) const;
+
+    /**
+     * charge the thread leaving the cpu with the time it ran. Its group was charged a whole
+     * quantum as it started, and gets back the pass of the part it left unused
+     * @param tp the running thread
+     */
+    void _chargeRunTime(Thread *tp);
+
+    /**
+     * park until a thread is READY, taking the resumes other pthreads post. The time parked is
+     * not charged to the thread that left the cpu
+     */
+    void _idleUntilReady();
+
+    /**
+     * publish the current state to the introspection snapshot, if introspection is on and a
+     * client waits for it
+     */
+    void _publishSnapshot();
+
+    /**
+     * recompute the effective priority of tp from its own priority and the threads synced on it,
+     * and pass a change on along the chain of threads tp waits for
+     * @param tp
+     */
+    void _updatePriority(Thread *tp);
+
+    /**
+     * un-sync the threads waiting for tp, adding the ones that aren't blocked to the queue
+     * @param tp
+     */
+    void _releaseDelayed(Thread *tp);
+
+    /**
+     * take thread tid out of the scheduler: run its thread specific destructors, drop its sync
+     * edges and remove it from the queue and the map. Its id is free again
+     * @param tid
+     * @return the thread, for the caller to delete
+     */
+    Thread *_unlinkThread(int tid);
+
+    /**
+     * resume the threads posted by other pthreads or signal handlers
+     */
+    void _takePostedResumes();
+
+public:
+
+    /**
+     * kill all threads except for the excluded tid
+     * @param excluded tid of thread to exclude from killing, -1 if non should be excluded
+     */
+    void killEmAll(int excluded);
+
+    /**
+     * Construct new scheduler
+     * @param quantumUsecs definition of class's quantum
+     * @param preemptive whether threads are preempted by the timer
+     */
+    BasicScheduler(int quantumUsecs, bool preemptive = true);
+
+    /**
+     * destructor of scheduler
+     */
+    ~BasicScheduler();
+
+    /**
+     * kill thread with tid
+     * @param tid
+     */
+    void _killThread(int tid);
+
+    /**
+     * creates new thread and adds it to queue
+     * @param f the function represented by thread
+     * @param group the group of the new thread
+     * @return 0 on success
+     */
+    int createNewThread(void (*f)(void), int group = DEFAULT_GROUP);
+
+    /**
+     * creates a new thread running closureRun on a closure kept at the top of its stack, and
+     * adds it to queue. The caller constructs the closure before the thread can run
+     * @param closureRun
+     * @param closureSize
+     * @param closureOut receives where the closure goes
+     * @return the new thread's id, -1 if there are no free ids
+     */
+    int createClosureThread(void (*closureRun)(void *, bool), size_t closureSize,
+                            void **closureOut);
+
+    /**
+     * remove a thread made by createClosureThread whose closure could not be constructed. The
+     * thread never ran and its closure is neither run nor destroyed
+     * @param tid
+     */
+    void abortClosureThread(int tid);
+
+    /**
+     * creates n new threads with one id scan and adds them to the queue in one operation
+     * @param f the function represented by the threads
+     * @param n number of threads to create
+     * @param tidsOut receives the ids of the new threads
+     * @return 0 on success, -1 if there are less than n free ids
+     */
+    int createNewThreads(void (*f)(void), int n, int *tidsOut);
+
+    /**
+     * terminates thread with tid
+     * @param tid
+     * @return 0 on success, -1 otherwise
+     */
+    int terminateThread(int tid);
+
+    /**
+     * block thread with tid
+     * @param tid
+     * @return 0 on success, -1 on failure
+     */
+    int blockThread(int tid);
+
+    /**
+     * resume blocked thread with tid
+     * @param tid
+     * @return 0 on success, -1 on failure
+     */
+    int resumeThread(int tid);
+
+    /**
+     * resume the n blocked threads in tids, adding the ready ones to the queue in one operation
+     * @param tids
+     * @param n
+     * @return 0 on success, -1 if one of the threads doesn't exist
+     */
+    int resumeThreads(const int *tids, int n);
+
+    /**
+     * sync the current thread with the thread 'tid'. Fails if tid is (or waits, through a chain
+     * of syncs, for) the current thread, since that would deadlock
+     * @param tid
+     * @return 0 on success, -1 otherwise
+     */
+    int syncThread(int tid);
+
+    /**
+     *
+     * @param tid
+     * @return whether a thread with tid exists
+     */
+    bool hasThread(int tid) const;
+
+    /**
+     * check blockThread(tid) would succeed, without blocking
+     * @param tid
+     * @return whether tid exists and, if it is the current thread, another thread is left to
+     * resume it
+     */
+    bool canBlock(int tid);
+
+    /**
+     * check syncThread(tid) would succeed, without syncing
+     * @param tid
+     * @return whether tid exists, isn't synced with the current thread and another thread can
+     * run, or idle parking waits for one
+     */
+    bool canSync(int tid);
+
+    /**
+     *
+     * @return current threads' tid
+     */
+    int getCurrentTid();
+
+    /**
+     *
+     * @return the running thread
+     */
+    Thread *getCurrentThread() const;
+
+    /**
+     *
+     * @return number of total quants elapsed in scheduler
+     */
+    int getTotalQuants();
+
+    /**
+     *
+     * @return whether any thread other than the running one is READY
+     */
+    bool hasReadyThreads() const;
+
+    /**
+     *
+     * @return length of the running thread's quantum in micro-seconds
+     */
+    int getCurrentQuantum() const;
+
+    /**
+     *
+     * @param tid
+     * @return quantum count of thread with tid
+     */
+    int getThreadQuants(int tid);
+
+    /**
+     *
+     * @param tid
+     * @return micro-seconds thread tid ran, partial quantums included, -1 if there is no such
+     * thread
+     */
+    long getThreadRunUsecs(int tid);
+
+    /**
+     * start/restart timer with the current thread's quantum
+     */
+    void startTimer();
+
+    void stopTimer();
+
+    /**
+     * switch between threads on signal sig. In safe point mode a preemption that is not forced
+     * only marks the quantum as over. A preemption switches only outside library calls
+     * (_libraryDepth == 0), which is what keeps it from re-entering the scheduler's arena it
+     * requeues the thread through
+     * @param sig 0 for a yield, the signal number for a preemption
+     */
+    void threadSwitch(int sig);
+
+    /**
+     * @param maxDeferred -1 to switch right in the signal handler, otherwise how many quantums
+     * past its own a thread outside the library runs before the handler switches it anyway
+     */
+    void setSafePoints(int maxDeferred);
+
+    /**
+     *
+     * @return whether safe point preemption is on, and library calls need no signal masking
+     */
+    bool usesSafePoints() const;
+
+    /**
+     *
+     * @return whether the running thread's quantum is over and it waits for a safe point
+     */
+    bool preemptPending() const;
+
+    /**
+     * the running thread enters a library call
+     */
+    void enterLibrary();
+
+    /**
+     * the running thread leaves a library call. Leaving the outermost one is a safe point, where
+     * a pending preemption is carried out
+     */
+    void leaveLibrary();
+
+    /**
+     * give the cpu to the next ready thread, the current thread goes to the end of the queue
+     */
+    void yieldThread();
+
+    /**
+     * change the signal mask of the running thread, as sigprocmask does. SIGVTALRM, SIGKILL and
+     * SIGSTOP are left out of the mask
+     * @param how SIG_BLOCK, SIG_UNBLOCK or SIG_SETMASK
+     * @param set signals to change, nullptr to change nothing
+     * @param oldset receives the mask before the change if not nullptr
+     * @return 0 on success, -1 if how is none of the above
+     */
+    int setSigMask(int how, const sigset_t *set, sigset_t *oldset);
+
+    /**
+     *
+     * @return whether threads are preempted by the timer
+     */
+    bool isPreemptive() const;
+
+    /**
+     * record the tid of every thread that gets the cpu, in order
+     * @param log where to record, nullptr to stop recording
+     * @param size capacity of log, recording stops when it is full
+     */
+    void setSwitchLog(int *log, int size);
+
+    /**
+     *
+     * @return number of switches recorded so far
+     */
+    int getSwitchCount() const;
+
+    /**
+     * follow a recorded order when picking the next thread. A recorded tid that is not ready
+     * at that point is skipped and the head of the queue runs instead
+     * @param log order recorded with setSwitchLog
+     * @param size number of entries in log
+     */
+    void setReplayLog(const int *log, int size);
+
+    /**
+     * free the threads that terminated themselves, called by every thread as it starts or
+     * resumes running
+     */
+    void reapDeadThreads();
+
+    /**
+     *
+     * @param tid
+     * @return environment of thread tid
+     */
+    sigjmp_buf *getEnvById(int tid);
+
+    /**
+     * change the quantum of all threads, taking effect with a new quantum for the current one
+     * @param quantumUsecs
+     */
+    void setQuantum(int quantumUsecs);
+
+    /**
+     * turn adaptive quantums on, every thread starting again from the scheduler's quantum
+     * @param minUsecs shortest quantum a thread can get
+     * @param maxUsecs longest quantum a thread can get
+     */
+    void setAdaptiveQuantum(int minUsecs, int maxUsecs);
+
+    /**
+     * @param lazy true to let the thread that runs after a yield, block or sync finish the
+     * running quantum instead of re-arming the timer for a full one
+     */
+    void setLazyTimer(bool lazy);
+
+    /**
+     * @param spins how long a thread blocking itself with no other thread ready polls for
+     * posted resumes before parking, -1 to fail the block instead
+     */
+    void setIdleSpins(int spins);
+
+    /**
+     * turn adaptive quantums off, all threads use the scheduler's quantum again
+     */
+    void clearAdaptiveQuantum();
+
+    /**
+     * start serving snapshots of the scheduler on a Unix domain socket. Stacks allocated from
+     * now on are painted so their high-water mark can be reported
+     * @param path
+     * @return 0 on success, -1 otherwise
+     */
+    int startIntrospection(const char *path);
+
+    /**
+     * stop serving snapshots
+     */
+    void stopIntrospection();
+
+    /**
+     * start capturing the library calls to a file at path
+     * @param path
+     * @return 0 on success, -1 if already capturing or the file can't be created
+     */
+    int startCapture(const char *path);
+
+    /**
+     * stop capturing and close the file
+     * @return 0 on success, -1 if not capturing or the file could not be written in full
+     */
+    int stopCapture();
+
+    /**
+     * record a call of the running thread, if capturing
+     * @param op CAPTURE_*
+     * @param target
+     */
+    void capture(int op, int target);
+
+    /**
+     * publish the scheduler's state for introspection, called at the end of every library call
+     */
+    void publishSnapshot();
+
+    /**
+     * set the priority of thread tid
+     * @param tid
+     * @param priority
+     * @return 0 on success, -1 if there is no such thread
+     */
+    int setPriority(int tid, int priority);
+
+    /**
+     * @param on whether the next thread is the ready one with the highest effective priority
+     * instead of the head of the queue
+     */
+    void setPriorityPolicy(bool on);
+
+    /**
+     * set whether thread tid's floating point control state is kept across its switches
+     * @param tid
+     * @param fpuUser
+     * @return 0 on success, -1 if there is no such thread
+     */
+    int setFpuUser(int tid, bool fpuUser);
+
+    /**
+     * allocate a thread specific storage key
+     * @param destructor called on a thread's non null value when the thread is killed
+     * @return the new key, -1 if all keys are in use
+     */
+    int createKey(void (*destructor)(void *));
+
+    /**
+     *
+     * @param key
+     * @return the current thread's value for key, nullptr if key was not created
+     */
+    void *getSpecific(uthread_key_t key) const;
+
+    /**
+     * set the current thread's value for key
+     * @param key
+     * @param value
+     * @return 0 on success, -1 if key was not created
+     */
+    int setSpecific(uthread_key_t key, void *value);
+
+    /**
+     * create a thread group
+     * @param weight quantums the group gets for every quantum of a group of weight 1
+     * @return the new group's id, -1 if all groups are in use
+     */
+    int createGroup(int weight);
+
+    /**
+     *
+     * @param gid
+     * @return whether group gid exists
+     */
+    bool isGroup(int gid) const;
+
+    /**
+     * @param gid
+     * @param weight
+     * @return 0 on success, -1 if there is no such group or weight is non-positive
+     */
+    int setGroupWeight(int gid, int weight);
+
+    /**
+     *
+     * @param gid
+     * @return quantums started by the threads of group gid, -1 if there is no such group
+     */
+    int getGroupQuants(int gid) const;
+
+    /**
+     *
+     * @param gid
+     * @return run time charged to the threads of group gid, the running thread's current
+     * quantum so far included, -1 if there is no such group
+     */
+    long getGroupRunUsecs(int gid);
+
+    /**
+     * terminate tid when it's the current thread
+     * @param tid
+     * @return 0 on success -1 otherwise
+     */
+    int terminateSelf(int tid);
+};
+
+//--------------functions-------------------
+BASIC_SCHEDULER_TEMPLATE
+BASIC_SCHEDULER::BasicScheduler(int quantumUsecs, bool preemptive)
+        : _numThreads(1),
+          _quantumsPassed(1),
+          _quantumUSecs(quantumUsecs % MICRO_SECS),
+          _quantumSecs(quantumUsecs / MICRO_SECS),
+          _adaptive(false),
+          _minQuantumUsecs(0),
+          _maxQuantumUsecs(0),
+          _lazyTimer(false),
+          _timerBackend(preemptive),
+          _appliedMask(),
+          _alarmLeftBlocked(false),
+          _priorityPolicy(false),
+          _idleSpins(-1),
+          _maxDeferred(-1),
+          _deferredQuants(0),
+          _libraryDepth(0),
+          _preemptPending(0),
+          _tidMap(),
+          _currentThread(),
+          _switchLog(nullptr),
+          _switchLogSize(0),
+          _switchCount(0),
+          _replayLog(nullptr),
+          _replayLogSize(0),
+          _replayPos(0),
+          _snapshot(nullptr),
+          _capture(nullptr),
+          _keyUsed(),
+          _keyDestructors(),
+          _numGroups(1),
+          _groupUsed(),
+          _groupWeight(),
+          _groupQuants(),
+          _groupRunUsecs(),
+          _groupPass(),
+          _groupVirtualTime(0),
+          _runningSinceNs(captureNow())
+{
+    try
+    {
+        _currentThread = new Thread(MAIN_TID, nullptr, nullptr);
+    }
+    catch (...)
+    {
+        std::cerr << SYS_ERROR << ALLOC_FAIL << std::endl;
+    }
+
+    for (auto &i : _tidMap)
+    {
+        i = nullptr;
+    }
+    _tidMap[MAIN_TID] = _currentThread;
+    // the main thread keeps the mask the process had
+    sigprocmask(SIG_BLOCK, nullptr, &_appliedMask);
+    sigdelset(&_appliedMask, SIGVTALRM);
+    _currentThread->setSigMask(_appliedMask);
+    _groupUsed[DEFAULT_GROUP] = true;
+    _groupWeight[DEFAULT_GROUP] = 1;
+    _groupQuants[DEFAULT_GROUP] = 1;
+    _currentThread->incQuants();
+    _instance = this;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+BASIC_SCHEDULER::~BasicScheduler()
+{
+    stopIntrospection();
+    if (_capture != nullptr)
+    { stopCapture(); }
+
+    killEmAll(-1);
+    reapDeadThreads();
+    _instance = nullptr;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+BASIC_SCHEDULER *BASIC_SCHEDULER::_instance = nullptr;
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_threadEntry()
+{
+    // a new thread starts with SIGVTALRM unblocked
+    _instance->_timerBackend.mask();
+    _instance->_alarmLeftBlocked = false;
+    _instance->reapDeadThreads();
+    _instance->_libraryDepth = 0;
+    _instance->_timerBackend.unmask();
+    _instance->_currentThread->runEntry();
+    // returning from the thread's function terminates it, there is no frame to return to. It
+    // is a library call like any other, the thread switched to finds SIGVTALRM as it expects
+    _instance->_libraryDepth = _instance->_libraryDepth + 1;
+    if (!_instance->usesSafePoints())
+    {
+        _instance->_timerBackend.mask();
+    }
+    _instance->capture(CAPTURE_EXIT, _instance->_currentThread->getId());
+    _instance->terminateSelf(_instance->_currentThread->getId());
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::killEmAll(int excluded)
+{
+    stopTimer();
+    for (int i = MaxThreads - 1; i > 0; i--)
+    {
+        if (_tidMap[i] != nullptr && i != excluded)
+        {
+            _killThread(i);
+        }
+    }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::createNewThread(void (*f)(void), int group)
+{
+    int newID = _getNextAvailableID();
+    if (newID == -1)
+    { return -1; }
+    try
+    {
+        auto newThread = new Thread(newID, f, _threadEntry);
+        newThread->setGroup(group);
+        _readyFreddie.push_back(newThread);
+        _tidMap[newID] = newThread;
+        _numThreads++;
+        return newID;
+    }
+    catch (...)
+    {
+
+        std::cerr << SYS_ERROR << ALLOC_FAIL << std::endl;
+        exit(SYS_ERR_CODE);
+    }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::createClosureThread(void (*closureRun)(void *, bool), size_t closureSize,
+                                   void **closureOut)
+{
+    int newID = _getNextAvailableID();
+    if (newID == -1)
+    { return -1; }
+    try
+    {
+        auto newThread = new Thread(newID, nullptr, _threadEntry, closureRun,
+                                    closureSize);
+        *closureOut = newThread->getClosure();
+        _readyFreddie.push_back(newThread);
+        _tidMap[newID] = newThread;
+        _numThreads++;
+        return newID;
+    }
+    catch (...)
+    {
+        std::cerr << SYS_ERROR << ALLOC_FAIL << std::endl;
+        exit(SYS_ERR_CODE);
+    }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::abortClosureThread(int tid)
+{
+    _tidMap[tid]->dropClosure();
+    _killThread(tid);
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::createNewThreads(void (*f)(void), int n, int *tidsOut)
+{
+    int found = 0;
+    for (int i = 0; i < MaxThreads && found < n; ++i)
+    {
+        if (_tidMap[i] == nullptr)
+        { tidsOut[found++] = i; }
+    }
+    if (found < n)
+    { return -1; }
+    try
+    {
+        Thread *batch[MaxThreads]; // n is at most the number of free ids
+        for (int i = 0; i < n; ++i)
+        {
+            auto newThread = new Thread(tidsOut[i], f, _threadEntry);
+            _tidMap[tidsOut[i]] = newThread;
+            batch[i] = newThread;
+        }
+        _readyFreddie.insert(_readyFreddie.end(), batch, batch + n);
+        _numThreads += n;
+        return 0;
+    }
+    catch (...)
+    {
+        std::cerr << SYS_ERROR << ALLOC_FAIL << std::endl;
+        exit(SYS_ERR_CODE);
+    }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+Thread *BASIC_SCHEDULER::_popNextThread()
+{
+    if (_readyFreddie.empty())
+    { return nullptr; }
+    int group = _pickGroup();
+    auto pos = _readyFreddie.begin();
+    if (group != -1)
+    {
+        while ((*pos)->getGroup() != group)
+        { pos++; }
+    }
+    Thread *retVal = *pos;
+    if (_priorityPolicy)
+    {
+        // first of the highest priority, so equal priorities stay round robin
+        for (auto it = pos; it != _readyFreddie.end(); it++)
+        {
+            if (group != -1 && (*it)->getGroup() != group)
+            { continue; }
+            if ((*it)->getEffectivePriority() > retVal->getEffectivePriority())
+            {
+                retVal = *it;
+                pos = it;
+            }
+        }
+    }
+    if (_replayPos < _replayLogSize)
+    {
+        int wantedTid = _replayLog[_replayPos++];
+        for (auto it = _readyFreddie.begin(); it != _readyFreddie.end(); it++)
+        {
+            if ((*it)->getId() == wantedTid)
+            {
+                retVal = *it;
+                pos = it;
+                break;
+            }
+        }
+    }
+    _readyFreddie.erase(pos);
+    if (_switchCount < _switchLogSize)
+    {
+        _switchLog[_switchCount++] = retVal->getId();
+    }
+    // retVal->incQuants();
+    //_quantumsPassed++;
+    return retVal;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::_pickGroup()
+{
+    if (_numGroups == 1)
+    { return -1; }
+    // lowest pass first, ties go to the group nearest the head of the queue
+    int best = -1;
+    for (Thread *tp : _readyFreddie)
+    {
+        int group = tp->getGroup();
+        if (_groupPass[group] < _groupVirtualTime)
+        {
+            _groupPass[group] = _groupVirtualTime; // was idle, it gets no credit for that
+        }
+        if (best == -1 || _groupPass[group] < _groupPass[best])
+        { best = group; }
+    }
+    _groupVirtualTime = _groupPass[best];
+    return best;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::createGroup(int weight)
+{
+    for (int gid = 0; gid < UTHREAD_GROUPS_MAX; ++gid)
+    {
+        if (!_groupUsed[gid])
+        {
+            _groupUsed[gid] = true;
+            _groupWeight[gid] = weight;
+            _groupQuants[gid] = 0;
+            _groupRunUsecs[gid] = 0;
+            _groupPass[gid] = _groupVirtualTime;
+            _numGroups++;
+            return gid;
+        }
+    }
+    return -1;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+bool BASIC_SCHEDULER::isGroup(int gid) const
+{
+    return gid >= 0 && gid < UTHREAD_GROUPS_MAX && _groupUsed[gid];
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::setGroupWeight(int gid, int weight)
+{
+    if (!isGroup(gid) || weight <= 0)
+    { return -1; }
+    _groupWeight[gid] = weight;
+    return 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::getGroupQuants(int gid) const
+{
+    if (!isGroup(gid))
+    { return -1; }
+    return _groupQuants[gid];
+}
+
+BASIC_SCHEDULER_TEMPLATE
+long BASIC_SCHEDULER::getGroupRunUsecs(int gid)
+{
+    if (!isGroup(gid))
+    { return -1; }
+    long ran = _groupRunUsecs[gid];
+    if (_currentThread->getGroup() == gid)
+    {
+        ran += (long) ((captureNow() - _runningSinceNs) / NANOS_PER_MICRO);
+    }
+    return ran;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::_getNextAvailableID()
+{
+    for (int i = 0; i < MaxThreads; ++i)
+    {
+        if (_tidMap[i] == nullptr)
+        { return i; }
+    }
+    return -1;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::threadSwitch(int sig)
+{
+    if (sig != 0 && _maxDeferred >= 0)
+    {
+        _deferredQuants++;
+        if (_libraryDepth > 0 || _deferredQuants <= _maxDeferred)
+        {
+            _preemptPending = 1;
+            return;
+        }
+    }
+    _requeueCurrent(sig == 0 ? SWITCH_YIELDED : SWITCH_PREEMPTED);
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_requeueCurrent(int reason)
+{
+    _takePostedResumes();
+    // the current thread competes too, so under the priority policy it keeps running when it is
+    // still the most important; round robin still picks it only when it is the only one
+    _currentThread->setState(READY);
+    _readyFreddie.push_back(_currentThread);
+    _switchTo(_popNextThread(), reason);
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::setSafePoints(int maxDeferred)
+{
+    _maxDeferred = maxDeferred;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+bool BASIC_SCHEDULER::usesSafePoints() const
+{
+    return _maxDeferred >= 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+bool BASIC_SCHEDULER::preemptPending() const
+{
+    return _preemptPending != 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::enterLibrary()
+{
+    _libraryDepth = _libraryDepth + 1;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::leaveLibrary()
+{
+    // the depth drops only after the switch, so the handler can't switch in the middle of it
+    if (_libraryDepth == 1 && _preemptPending)
+    {
+        _requeueCurrent(SWITCH_DEFERRED);
+    }
+    _libraryDepth = _libraryDepth - 1;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_enterThread(Thread *next, int reason)
+{
+    Thread *prev = _currentThread;
+    _chargeRunTime(prev); // a terminated thread is still there until the next one reaps it
+    if (reason != SWITCH_TERMINATED)
+    {
+        _adaptQuantum(prev, reason == SWITCH_PREEMPTED || reason == SWITCH_DEFERRED);
+        if (reason != SWITCH_PREEMPTED) // in a signal handler the kernel saved the fpu state
+        {
+            prev->saveFpuState();
+        }
+    }
+    if (_capture != nullptr)
+    { _capture->switched(prev->getId()); }
+    next->setState(RUNNING);
+    next->incQuants();
+    _quantumsPassed++;
+    _groupQuants[next->getGroup()]++;
+    _groupPass[next->getGroup()] += GROUP_STRIDE / _groupWeight[next->getGroup()];
+    _currentThread = next;
+    _runningSinceNs = captureNow();
+    _preemptPending = 0;
+    _deferredQuants = 0;
+    next->restoreFpuState();
+    _applySigMask(next->getSigMask());
+    _publishSnapshot();
+
+    // a preemption finds the interval timer already reloaded, and a voluntary switch may
+    // leave the rest of the running quantum to the next thread
+    int quantum = _currentQuantum();
+    if (quantum != _timerBackend.armed() ||
+        (reason != SWITCH_PREEMPTED && !_lazyTimer))
+    {
+        startTimer();
+    }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_switchTo(Thread *next, int reason)
+{
+    Thread *prev = _currentThread;
+    _enterThread(next, reason);
+    if (next == prev) // the only ready thread goes on, in a new quantum
+    {
+        return;
+    }
+    int depth = _libraryDepth;
+    if (sigsetjmp(_env[prev->getId()], 0) == 1)
+    {
+        // prev is back inside as many library calls as when it left
+        _libraryDepth = depth;
+        // with safe points a thread left outside the handler runs with SIGVTALRM unblocked,
+        // but a switch from the handler keeps it blocked until the handler returns
+        if (_alarmLeftBlocked && reason != SWITCH_PREEMPTED && usesSafePoints())
+        {
+            _timerBackend.unmask();
+        }
+        _alarmLeftBlocked = false;
+        reapDeadThreads();
+        return; // switched back to prev
+    }
+    _alarmLeftBlocked = reason == SWITCH_PREEMPTED;
+    siglongjmp(_env[next->getId()], 1);
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_applySigMask(const sigset_t &mask)
+{
+    if (memcmp(&mask, &_appliedMask, sizeof(sigset_t)) == 0) // the common case, no syscall
+    {
+        return;
+    }
+    sigset_t block, unblock;
+    sigemptyset(&block);
+    sigemptyset(&unblock);
+    for (int sig = 1; sig < NSIG; ++sig)
+    {
+        bool wanted = sigismember(&mask, sig) == 1, applied = sigismember(&_appliedMask, sig) == 1;
+        if (wanted && !applied)
+        { sigaddset(&block, sig); }
+        else if (applied && !wanted)
+        { sigaddset(&unblock, sig); }
+    }
+    if (!sigisemptyset(&block))
+    { sigprocmask(SIG_BLOCK, &block, nullptr); }
+    if (!sigisemptyset(&unblock))
+    { sigprocmask(SIG_UNBLOCK, &unblock, nullptr); }
+    _appliedMask = mask;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::setSigMask(int how, const sigset_t *set, sigset_t *oldset)
+{
+    if (how != SIG_BLOCK && how != SIG_UNBLOCK && how != SIG_SETMASK)
+    {
+        return -1;
+    }
+    sigset_t mask = _currentThread->getSigMask();
+    if (oldset != nullptr)
+    {
+        *oldset = mask;
+    }
+    if (set == nullptr)
+    {
+        return 0;
+    }
+    for (int sig = 1; sig < NSIG; ++sig)
+    {
+        // SIGVTALRM is the scheduler's, and the kernel won't block SIGKILL and SIGSTOP
+        if (sig == SIGVTALRM || sig == SIGKILL || sig == SIGSTOP)
+        { continue; }
+        if (sigismember(set, sig) == 1)
+        {
+            if (how == SIG_UNBLOCK)
+            { sigdelset(&mask, sig); }
+            else
+            { sigaddset(&mask, sig); }
+        }
+        else if (how == SIG_SETMASK)
+        {
+            sigdelset(&mask, sig);
+        }
+    }
+    _currentThread->setSigMask(mask);
+    _applySigMask(mask);
+    return 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::blockThread(int tid)
+{
+    if (!canBlock(tid)) // no such thread, or no thread is left to ever resume us
+    {
+        return -1;
+    }
+    if (tid == _currentThread->getId()) // Thread blocking itself
+    {
+        _currentThread->setState(BLOCKED);
+        _idleUntilReady(); // idle: wait for another pthread to post a resume
+        _switchTo(_popNextThread(), SWITCH_BLOCKED);
+        return 0; // resumed
+    }
+    // else: block other thread
+
+    for (auto it = _readyFreddie.cbegin(); it != _readyFreddie.cend(); it++)
+    {
+        Thread *tp = *it;
+        if (tid == tp->getId())
+        {
+            tp->setState(BLOCKED);
+            _readyFreddie.erase(it);
+            return 0;
+        }
+    } // thread not found in queue - it is either block or synced
+
+    Thread *tp = _tidMap[tid];
+    if (tp->getState() == BLOCKED)
+    { return 0; } // already blocked
+    else
+    {
+        tp->setState(BLOCKED); // thread is not in queue - it's (probably) synced
+        return 0;
+    }
+}
+
+/*
+ * executes the process of terminating a thread, deciding the actions to be taken according to
+ * thread state
+ */
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::terminateThread(int tid)
+{
+    if (_tidMap[tid] == nullptr) // trying to kill non-existent thread
+    {
+        return -1;
+    }
+
+    if (_currentThread->getId() == tid)
+    {
+        return terminateSelf(tid);
+    }
+
+    _killThread(tid);
+    return 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::terminateSelf(int tid)
+{
+    // the threads synced on us are ready before the next thread is picked. We still run on our
+    // own stack, so the thread is only unlinked here and freed by the next thread
+    _deadThreads.push_back(_unlinkThread(tid));
+    _takePostedResumes();
+    if (_readyFreddie.empty() && _idleSpins < 0)
+    {
+        std::cerr << SYS_ERROR << NO_THREAD_LEFT << std::endl;
+        exit(SYS_ERR_CODE);
+    }
+    _idleUntilReady();
+    Thread *newThread = _popNextThread();
+    _enterThread(newThread, SWITCH_TERMINATED);
+    siglongjmp(_env[newThread->getId()], 1);
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::reapDeadThreads()
+{
+    if (_deadThreads.empty())
+    { return; }
+    for (Thread *tp : _deadThreads)
+    {
+        delete tp;
+    }
+    _deadThreads.clear();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_takePostedResumes()
+{
+    if (!idleHasPosts())
+    { return; }
+    int tids[MAX_THREAD_NUM];
+    int n = idleTakePosts(tids);
+    for (int i = 0; i < n; ++i)
+    {
+        if (tids[i] < MaxThreads && _tidMap[tids[i]] != nullptr)
+        { resumeThread(tids[i]); }
+    }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::setIdleSpins(int spins)
+{
+    _idleSpins = spins;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_releaseDelayed(Thread *tp)
+{
+    if (!tp->get_imDelaying())
+    { return; }
+    TidList delayedList = tp->getDelayedByMeTids();
+    for (auto it = delayedList.cbegin(); it != delayedList.cend(); it++)
+    {
+        Thread *waiter = _tidMap[*it];
+        waiter->setImWaiting(false, nullptr);
+        tp->removeDelayedByMe(*it);
+        if (waiter->getState() != BLOCKED)
+        {
+            _readyFreddie.push_back(waiter);
+        }
+    }
+}
+
+/*
+ * thread delete and free synced threads
+ */
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_killThread(int tid)
+{
+    delete _unlinkThread(tid);
+}
+
+BASIC_SCHEDULER_TEMPLATE
+Thread *BASIC_SCHEDULER::_unlinkThread(int tid)
+{
+    Thread *threadToTerminate = _tidMap[tid];
+    //release the thread specific values
+    for (int key = 0; key < UTHREAD_KEYS_MAX; ++key)
+    {
+        void *value = threadToTerminate->getSpecific(key);
+        if (value != nullptr && _keyDestructors[key] != nullptr)
+        {
+            threadToTerminate->setSpecific(key, nullptr);
+            _keyDestructors[key](value);
+        }
+    }
+    //take the TBK off the lock or barrier it waits on
+    threadToTerminate->cancelWait();
+    //remove the TBK from any thread that might be blocking it
+    if (threadToTerminate->amIwaiting())
+    {
+        Thread *delayingTp = threadToTerminate->get_imWaitingForTP();
+        delayingTp->removeDelayedByMe(tid);
+        threadToTerminate->setImWaiting(false, nullptr);
+        _updatePriority(delayingTp);
+    }
+    //un-sync all threads that are waiting for thread TBK
+    _releaseDelayed(threadToTerminate);
+    //check if in ready list and delete
+    for (auto it = _readyFreddie.cbegin(); it != _readyFreddie.cend(); it++)
+    {
+        Thread *tp = *it;
+        if (tid == tp->getId())
+        {
+            _readyFreddie.erase(it);
+            break;
+        }
+    }
+    _tidMap[tid] = nullptr;
+    return threadToTerminate;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::resumeThread(int tid)
+{
+    if (_tidMap[tid] == nullptr)
+    { return -1; }
+
+    Thread *threadToResume = _tidMap[tid];
+
+    if (threadToResume->getState() == BLOCKED)
+    {
+        threadToResume->setState(READY);
+        if (!threadToResume->amIwaiting())
+        {
+            _readyFreddie.push_back(threadToResume);
+        }
+    }
+    return 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::resumeThreads(const int *tids, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        if (_tidMap[tids[i]] == nullptr)
+        { return -1; }
+    }
+
+    Thread *batch[MaxThreads]; // a thread is made READY once however often it is listed
+    int batched = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        Thread *threadToResume = _tidMap[tids[i]];
+        if (threadToResume->getState() == BLOCKED)
+        {
+            threadToResume->setState(READY);
+            if (!threadToResume->amIwaiting())
+            {
+                batch[batched++] = threadToResume;
+            }
+        }
+    }
+    _readyFreddie.insert(_readyFreddie.end(), batch, batch + batched);
+    return 0;
+}
+
+//block running thread by tid
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::syncThread(int tid)
+{
+    if (!canSync(tid))
+    { return -1; }
+    Thread *delayingTp = _tidMap[tid];
+    _currentThread->setState(READY); // we assume it isn't blocked because it's running..
+    _currentThread->setImWaiting(true, delayingTp);
+    delayingTp->addDelayedByMe(_currentThread->getId());
+    // inherit before picking the next thread, so the thread we wait for can be picked
+    _updatePriority(delayingTp);
+    _idleUntilReady(); // idle: wait for another pthread to post a resume
+    _switchTo(_popNextThread(), SWITCH_SYNCED);
+
+    return 0; // the thread we waited for terminated
+}
+
+
+BASIC_SCHEDULER_TEMPLATE
+bool BASIC_SCHEDULER::hasThread(int tid) const
+{
+    return tid >= 0 && tid < MaxThreads && _tidMap[tid] != nullptr;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+bool BASIC_SCHEDULER::canBlock(int tid)
+{
+    if (!hasThread(tid))
+    { return false; }
+    if (tid != _currentThread->getId())
+    { return true; }
+    _takePostedResumes();
+    return !_readyFreddie.empty() || _idleSpins >= 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+bool BASIC_SCHEDULER::canSync(int tid)
+{
+    Thread *delayingTp = hasThread(tid) ? _tidMap[tid] : nullptr;
+    if (delayingTp == nullptr) // there is no thread with tid
+    { return false; }
+    // walk the wait-for chain, reaching ourselves means the sync closes a cycle
+    for (Thread *tp = delayingTp; tp != nullptr; tp = tp->get_imWaitingForTP())
+    {
+        if (tp == _currentThread)
+        { return false; }
+    }
+    _takePostedResumes();
+    return !_readyFreddie.empty() || _idleSpins >= 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::getCurrentTid()
+{
+    return _currentThread->getId();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+Thread *BASIC_SCHEDULER::getCurrentThread() const
+{
+    return _currentThread;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::getTotalQuants()
+{
+    return _quantumsPassed;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+bool BASIC_SCHEDULER::hasReadyThreads() const
+{
+    return !_readyFreddie.empty();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::getCurrentQuantum() const
+{
+    return _currentQuantum();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::getThreadQuants(int tid)
+{
+    if (_tidMap[tid] == nullptr)
+    { return -1; }
+    return _tidMap[tid]->getQuants();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+long BASIC_SCHEDULER::getThreadRunUsecs(int tid)
+{
+    if (_tidMap[tid] == nullptr)
+    { return -1; }
+    long ran = _tidMap[tid]->getRunUsecs();
+    if (_tidMap[tid] == _currentThread) // and the part of its quantum it ran so far
+    {
+        ran += (long) ((captureNow() - _runningSinceNs) / NANOS_PER_MICRO);
+    }
+    return ran;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::startTimer()
+{
+    _timerBackend.start(_currentQuantum());
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::stopTimer()
+{
+    _timerBackend.stop();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::yieldThread()
+{
+    threadSwitch(0);
+}
+
+BASIC_SCHEDULER_TEMPLATE
+bool BASIC_SCHEDULER::isPreemptive() const
+{
+    return _timerBackend.isPreemptive();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::setSwitchLog(int *log, int size)
+{
+    _switchLog = log;
+    _switchLogSize = log == nullptr ? 0 : size;
+    _switchCount = 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::getSwitchCount() const
+{
+    return _switchCount;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::setReplayLog(const int *log, int size)
+{
+    _replayLog = log;
+    _replayLogSize = log == nullptr ? 0 : size;
+    _replayPos = 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::_currentQuantum() const
+{
+    if (!_adaptive)
+    {
+        return _quantumSecs * MICRO_SECS + _quantumUSecs;
+    }
+    if (_currentThread->getQuantum() > 0)
+    {
+        return _currentThread->getQuantum();
+    }
+    // a thread that was not adapted yet starts from the scheduler's quantum, kept in range
+    return _clampQuantum(_quantumSecs * MICRO_SECS + _quantumUSecs);
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_idleUntilReady()
+{
+    if (!_readyFreddie.empty())
+    { return; }
+    uint64_t parkedSince = captureNow();
+    while (_readyFreddie.empty())
+    {
+        idleWait(_idleSpins);
+        _takePostedResumes();
+    }
+    uint64_t parked = captureNow() - parkedSince;
+    _runningSinceNs += parked;
+    if (_capture != nullptr)
+    { _capture->idled(parked); }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_chargeRunTime(Thread *tp)
+{
+    long ran = (long) ((captureNow() - _runningSinceNs) / NANOS_PER_MICRO);
+    tp->addRunUsecs(ran);
+    _groupRunUsecs[tp->getGroup()] += ran;
+    long quantum = _currentQuantum();
+    if (ran < quantum)
+    {
+        int group = tp->getGroup();
+        _groupPass[group] -= GROUP_STRIDE / _groupWeight[group] * (quantum - ran) / quantum;
+    }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::_clampQuantum(int quantumUsecs) const
+{
+    if (quantumUsecs < _minQuantumUsecs)
+    { return _minQuantumUsecs; }
+    if (quantumUsecs > _maxQuantumUsecs)
+    { return _maxQuantumUsecs; }
+    return quantumUsecs;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::setLazyTimer(bool lazy)
+{
+    _lazyTimer = lazy;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_adaptQuantum(Thread *tp, bool exhausted)
+{
+    if (!_adaptive)
+    { return; }
+    int quantum = tp->getQuantum();
+    if (quantum == 0)
+    {
+        quantum = _quantumSecs * MICRO_SECS + _quantumUSecs;
+    }
+    if (exhausted)
+    {
+        quantum = quantum > _maxQuantumUsecs / 2 ? _maxQuantumUsecs : quantum * 2;
+    }
+    else
+    {
+        quantum /= 2;
+    }
+    tp->setQuantum(_clampQuantum(quantum));
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::setQuantum(int quantumUsecs)
+{
+    _quantumUSecs = quantumUsecs % MICRO_SECS;
+    _quantumSecs = quantumUsecs / MICRO_SECS;
+    for (Thread *tp : _tidMap)
+    {
+        if (tp != nullptr)
+        { tp->setQuantum(0); }
+    }
+    startTimer();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::setAdaptiveQuantum(int minUsecs, int maxUsecs)
+{
+    _adaptive = true;
+    _minQuantumUsecs = minUsecs;
+    _maxQuantumUsecs = maxUsecs;
+    for (Thread *tp : _tidMap)
+    {
+        if (tp != nullptr)
+        { tp->setQuantum(0); }
+    }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::clearAdaptiveQuantum()
+{
+    _adaptive = false;
+    startTimer();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_publishSnapshot()
+{
+    // the copy is only made when a client waits for it
+    if (_snapshot == nullptr || !_snapshot->wanted())
+    { return; }
+    SchedulerSnapshot &snap = _snapshot->beginWrite();
+    snap.totalQuants = _quantumsPassed;
+    snap.currentTid = _currentThread->getId();
+    snap.numThreads = _numThreads;
+    snap.readyLength = (int) _readyFreddie.size();
+    for (int tid = 0; tid < MAX_THREAD_NUM; ++tid)
+    {
+        ThreadSnapshot &t = snap.threads[tid];
+        Thread *tp = tid < MaxThreads ? _tidMap[tid] : nullptr;
+        if (tp == nullptr)
+        {
+            t.tid = NO_THREAD;
+            continue;
+        }
+        if (tid != MAIN_TID)
+        {
+            tp->updateStackHighWater();
+        }
+        t.tid = tid;
+        t.state = tp == _currentThread ? RUNNING : tp->getState();
+        t.quants = tp->getQuants();
+        t.syncedWith = tp->amIwaiting() ? tp->get_imWaitingForTP()->getId() : NO_THREAD;
+        t.priority = tp->getEffectivePriority();
+        t.group = tp->getGroup();
+        t.stackHighWater = tp->getStackHighWater();
+    }
+    _snapshot->endWrite();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::publishSnapshot()
+{
+    _publishSnapshot();
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::startIntrospection(const char *path)
+{
+    if (_snapshot != nullptr)
+    { return -1; }
+    try
+    {
+        _snapshot = new SnapshotSeqlock();
+    }
+    catch (...)
+    {
+        std::cerr << SYS_ERROR << ALLOC_FAIL << std::endl;
+        exit(SYS_ERR_CODE);
+    }
+    StackAllocator::setPaint(true);
+    _publishSnapshot();
+    if (introspectStart(path, _snapshot) == -1)
+    {
+        StackAllocator::setPaint(false);
+        delete _snapshot;
+        _snapshot = nullptr;
+        return -1;
+    }
+    return 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::stopIntrospection()
+{
+    if (_snapshot == nullptr)
+    { return; }
+    introspectStop();
+    StackAllocator::setPaint(false);
+    delete _snapshot;
+    _snapshot = nullptr;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::startCapture(const char *path)
+{
+    if (_capture != nullptr)
+    { return -1; }
+    try
+    {
+        _capture = new CaptureLog();
+    }
+    catch (...)
+    {
+        std::cerr << SYS_ERROR << ALLOC_FAIL << std::endl;
+        exit(SYS_ERR_CODE);
+    }
+    if (_capture->open(path, _quantumSecs * MICRO_SECS + _quantumUSecs, isPreemptive()) == -1)
+    {
+        delete _capture;
+        _capture = nullptr;
+        return -1;
+    }
+    return 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::stopCapture()
+{
+    if (_capture == nullptr)
+    { return -1; }
+    int success = _capture->close();
+    delete _capture;
+    _capture = nullptr;
+    return success;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::capture(int op, int target)
+{
+    if (_capture != nullptr)
+    { _capture->record(op, _currentThread->getId(), target); }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::_updatePriority(Thread *tp)
+{
+    while (tp != nullptr)
+    {
+        int priority = tp->getPriority();
+        for (int waiterTid : tp->getDelayedByMeTids())
+        {
+            if (_tidMap[waiterTid]->getEffectivePriority() > priority)
+            { priority = _tidMap[waiterTid]->getEffectivePriority(); }
+        }
+        if (priority == tp->getEffectivePriority())
+        { return; }
+        tp->setEffectivePriority(priority);
+        tp = tp->get_imWaitingForTP();
+    }
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::setPriority(int tid, int priority)
+{
+    if (_tidMap[tid] == nullptr)
+    { return -1; }
+    _tidMap[tid]->setPriority(priority);
+    _updatePriority(_tidMap[tid]);
+    return 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void BASIC_SCHEDULER::setPriorityPolicy(bool on)
+{
+    _priorityPolicy = on;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::setFpuUser(int tid, bool fpuUser)
+{
+    if (_tidMap[tid] == nullptr)
+    { return -1; }
+    _tidMap[tid]->setFpuUser(fpuUser);
+    return 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::createKey(void (*destructor)(void *))
+{
+    for (int key = 0; key < UTHREAD_KEYS_MAX; ++key)
+    {
+        if (!_keyUsed[key])
+        {
+            _keyUsed[key] = true;
+            _keyDestructors[key] = destructor;
+            return key;
+        }
+    }
+    return -1;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+void *BASIC_SCHEDULER::getSpecific(uthread_key_t key) const
+{
+    if (key < 0 || key >= UTHREAD_KEYS_MAX || !_keyUsed[key])
+    { return nullptr; }
+    return _currentThread->getSpecific(key);
+}
+
+BASIC_SCHEDULER_TEMPLATE
+int BASIC_SCHEDULER::setSpecific(uthread_key_t key, void *value)
+{
+    if (key < 0 || key >= UTHREAD_KEYS_MAX || !_keyUsed[key])
+    { return -1; }
+    _currentThread->setSpecific(key, value);
+    return 0;
+}
+
+BASIC_SCHEDULER_TEMPLATE
+sigjmp_buf *BASIC_SCHEDULER::getEnvById(int tid)
+{
+    return &_env[tid];
+}
+
+#endif //EX2_BASICSCHEDULER_H
@@ -0,0 +1,126 @@
+//------------------includes--------------------
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Capture.h"
+
+//------------------defines--------------------
+#define NANOS_PER_MICRO 1000
+#define SATURATED_US 0xffffffffUL
+
+//------------------functions-------------------
+uint64_t captureNow()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+static uint32_t toSaturatedUs(uint64_t ns)
+{
+    uint64_t us = ns / NANOS_PER_MICRO;
+    return us > SATURATED_US ? (uint32_t) SATURATED_US : (uint32_t) us;
+}
+
+// write all of len bytes
+static bool writeAll(int fd, const void *data, size_t len)
+{
+    const char *p = static_cast<const char *>(data);
+    while (len > 0)
+    {
+        ssize_t written = write(fd, p, len);
+        if (written <= 0)
+        { return false; }
+        p += written;
+        len -= (size_t) written;
+    }
+    return true;
+}
+
+CaptureLog::CaptureLog() : _fd(-1), _failed(false), _buffer(), _used(0), _lastNs(0),
+                           _runningSince(0), _ranNs()
+{
+}
+
+int CaptureLog::open(const char *path, int quantumUsecs, bool preemptive)
+{
+    _fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (_fd < 0)
+    { return -1; }
+    CaptureHeader header = {CAPTURE_MAGIC, CAPTURE_VERSION, quantumUsecs, preemptive ? 1 : 0};
+    if (!writeAll(_fd, &header, sizeof(header)))
+    {
+        ::close(_fd);
+        _fd = -1;
+        return -1;
+    }
+    _lastNs = _runningSince = captureNow();
+    return 0;
+}
+
+int CaptureLog::close()
+{
+    _flush();
+    if (::close(_fd) < 0)
+    { _failed = true; }
+    _fd = -1;
+    return _failed ? -1 : 0;
+}
+
+void CaptureLog::_flush()
+{
+    if (_used > 0 && !_failed && !writeAll(_fd, _buffer, _used * sizeof(CaptureRecord)))
+    {
+        _failed = true;
+    }
+    _used = 0;
+}
+
+void CaptureLog::switched(int prevTid)
+{
+    uint64_t now = captureNow();
+    _ranNs[prevTid] += now - _runningSince;
+    _runningSince = now;
+}
+
+void CaptureLog::idled(uint64_t ns)
+{
+    _runningSince += ns;
+}
+
+void CaptureLog::record(int op, int caller, int target)
+{
+    uint64_t now = captureNow();
+    CaptureRecord &r = _buffer[_used++];
+    r.deltaUs = toSaturatedUs(now - _lastNs);
+    r.burstUs = toSaturatedUs(_ranNs[caller] + now - _runningSince);
+    r.caller = (int16_t) caller;
+    r.target = (int16_t) target;
+    r.op = (uint8_t) op;
+    _ranNs[caller] = 0;
+    _runningSince = _lastNs = now;
+    if (_used == CAPTURE_BUFFER)
+    { _flush(); }
+}
+
+int captureRead(const char *path, CaptureHeader &header, std::vector<CaptureRecord> &records)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr)
+    { return -1; }
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != CAPTURE_MAGIC ||
+        header.version != CAPTURE_VERSION)
+    {
+        fclose(file);
+        return -1;
+    }
+    records.clear();
+    CaptureRecord r;
+    while (fread(&r, sizeof(r), 1, file) == 1)
+    {
+        records.push_back(r);
+    }
+    fclose(file);
+    return 0;
+}
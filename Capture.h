@@ -0,0 +1,127 @@
+//
+// Capturing the library calls of a workload to a compact binary file, for uthread_replay to
+// reproduce against another scheduler configuration.
+//
+
+#ifndef EX2_CAPTURE_H
+#define EX2_CAPTURE_H
+
+//------------------includes--------------------
+#include <cstdint>
+#include <vector>
+#include "uthreads.h"
+
+//------------------defines--------------------
+#define CAPTURE_MAGIC 0x50435455 // "UTCP"
+#define CAPTURE_VERSION 1
+#define CAPTURE_BUFFER 256 // records written to the file at once
+
+// what a record is for, the call made by the record's caller
+#define CAPTURE_SPAWN 0     // target is the new thread
+#define CAPTURE_TERMINATE 1
+#define CAPTURE_EXIT 2      // the caller returned from its thread function
+#define CAPTURE_BLOCK 3
+#define CAPTURE_RESUME 4
+#define CAPTURE_SYNC 5
+#define CAPTURE_YIELD 6
+
+//---------------structs---------------------------
+
+/**
+ * start of a capture file, followed by CaptureRecords up to the end of the file
+ */
+struct CaptureHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    int32_t quantumUsecs;
+    int32_t preemptive;
+};
+
+struct CaptureRecord
+{
+    uint32_t deltaUs; // since the previous record, saturated
+    uint32_t burstUs; // cpu time the caller ran since its previous record, saturated
+    int16_t caller;
+    int16_t target;   // thread the call is made on, the caller for EXIT and YIELD
+    uint8_t op;       // CAPTURE_*
+    uint8_t reserved[3];
+};
+
+//---------------class---------------------------
+
+/**
+ * The open capture file of a scheduler. The scheduler tells it of every switch, so the cpu
+ * time of each thread is known, and of every captured call. Records are buffered and written
+ * with the library locked.
+ */
+class CaptureLog
+{
+private:
+    int _fd;
+    bool _failed; // a write failed, the file is incomplete
+    CaptureRecord _buffer[CAPTURE_BUFFER];
+    int _used;
+    uint64_t _lastNs;          // time of the previous record
+    uint64_t _runningSince;    // when the running thread got the cpu, or made its last call
+    uint64_t _ranNs[MAX_THREAD_NUM]; // cpu time of every thread since its previous record
+
+    void _flush();
+
+public:
+    CaptureLog();
+
+    /**
+     * create the file at path and write its header
+     * @param path
+     * @param quantumUsecs
+     * @param preemptive
+     * @return 0 on success, -1 if the file can't be created
+     */
+    int open(const char *path, int quantumUsecs, bool preemptive);
+
+    /**
+     * write what is buffered and close the file
+     * @return 0 on success, -1 if any write failed
+     */
+    int close();
+
+    /**
+     * the running thread, prevTid, leaves the cpu
+     * @param prevTid
+     */
+    void switched(int prevTid);
+
+    /**
+     * the cpu was parked for ns, which no thread ran
+     * @param ns
+     */
+    void idled(uint64_t ns);
+
+    /**
+     * record a call
+     * @param op CAPTURE_*
+     * @param caller the running thread
+     * @param target
+     */
+    void record(int op, int caller, int target);
+};
+
+//--------------functions-------------------
+
+/**
+ *
+ * @return CLOCK_MONOTONIC in nano-seconds
+ */
+uint64_t captureNow();
+
+/**
+ * read a capture file
+ * @param path
+ * @param header receives the header
+ * @param records receives the records
+ * @return 0 on success, -1 if the file can't be read or isn't a capture
+ */
+int captureRead(const char *path, CaptureHeader &header, std::vector<CaptureRecord> &records);
+
+#endif //EX2_CAPTURE_H
@@ -0,0 +1,229 @@
+//------------------includes--------------------
+#include <queue>
+#include <vector>
+#include <functional>
+#include "Scheduler.h"
+#include "Coroutine.h"
+
+extern Scheduler *manager;
+
+//--------------ERRORS----------------------
+#define CO_HOST_ERR "coroutine host could not be spawned"
+
+//------------------defines--------------------
+#define MICROS_PER_MILLI 1000
+
+//---------------global variables----------------
+typedef std::pair<int, void *> CoSleeper; // wake quantum, coroutine address
+
+// ready tasks, only touched from the host thread so no masking is needed
+static std::deque<std::coroutine_handle<>> coReady;
+// tasks spawned from other uthreads, touched with SIGVTALRM blocked
+static std::deque<std::coroutine_handle<>> coInbox;
+static std::priority_queue<CoSleeper, std::vector<CoSleeper>, std::greater<CoSleeper>> coSleepers;
+static std::vector<UCoWaitFd *> coFdWaiters;
+static std::vector<pollfd> coPollFds;
+static int coHostTid = -1;
+static bool coHostParked = false;
+
+//--------------functions-------------------
+void coMakeReady(std::coroutine_handle<> handle)
+{
+    coReady.push_back(handle);
+}
+
+void coSleepUntil(std::coroutine_handle<> handle, int wakeQuantum)
+{
+    coSleepers.push(CoSleeper(wakeQuantum, handle.address()));
+}
+
+void *coAllocFrame(size_t size)
+{
+    blockAlarm();
+    void *frame = ::operator new(size);
+    unblockAlarm();
+    return frame;
+}
+
+void coFreeFrame(void *frame)
+{
+    blockAlarm();
+    ::operator delete(frame);
+    unblockAlarm();
+}
+
+bool UCoSleep::await_ready() const noexcept
+{
+    return manager->getTotalQuants() >= wakeQuantum;
+}
+
+void UCoWaitFd::await_suspend(std::coroutine_handle<> h)
+{
+    handle = h;
+    coFdWaiters.push_back(this);
+}
+
+// move tasks spawned by other uthreads to the host's own ready queue
+static void coDrainInbox()
+{
+    if (coInbox.empty())
+    { return; }
+    blockAlarm();
+    for (auto h : coInbox)
+    {
+        coReady.push_back(h);
+    }
+    coInbox.clear();
+    unblockAlarm();
+}
+
+static void coWakeSleepers()
+{
+    int now = manager->getTotalQuants();
+    while (!coSleepers.empty() && coSleepers.top().first <= now)
+    {
+        coReady.push_back(std::coroutine_handle<>::from_address(coSleepers.top().second));
+        coSleepers.pop();
+    }
+}
+
+// a single poll over every waiting descriptor, waiting up to timeoutMs for one to be ready
+static void coPollWaiters(int timeoutMs)
+{
+    if (coFdWaiters.empty() && timeoutMs == 0)
+    { return; }
+    coPollFds.resize(coFdWaiters.size());
+    for (size_t i = 0; i < coFdWaiters.size(); ++i)
+    {
+        coPollFds[i].fd = coFdWaiters[i]->fd;
+        coPollFds[i].events = coFdWaiters[i]->events;
+        coPollFds[i].revents = 0;
+    }
+    if (poll(coPollFds.data(), coPollFds.size(), timeoutMs) <= 0)
+    { return; }
+    size_t kept = 0;
+    for (size_t i = 0; i < coFdWaiters.size(); ++i)
+    {
+        if (coPollFds[i].revents != 0)
+        {
+            coFdWaiters[i]->revents = coPollFds[i].revents;
+            coReady.push_back(coFdWaiters[i]->handle);
+        }
+        else
+        {
+            coFdWaiters[kept++] = coFdWaiters[i];
+        }
+    }
+    coFdWaiters.resize(kept);
+}
+
+/*
+ * entry point of the coroutine host uthread: runs the ready tasks round robin, and when there
+ * are none either gives its quantum away (tasks are sleeping or waiting on I/O) or blocks itself
+ * until uthread_co_spawn resumes it. With no other uthread ready it waits in poll for a quantum
+ * instead of yielding back to itself
+ */
+static void coHostMain()
+{
+    for (;;)
+    {
+        coDrainInbox();
+        coWakeSleepers();
+        coPollWaiters(0);
+        if (coReady.empty())
+        {
+            blockAlarm();
+            if (coInbox.empty())
+            {
+                if (coSleepers.empty() && coFdWaiters.empty())
+                {
+                    coHostParked = true;
+                    manager->blockThread(coHostTid);
+                }
+                else if (manager->hasReadyThreads())
+                {
+                    manager->yieldThread();
+                }
+                else
+                {
+                    // the quantum the host would spin through passes in poll, and the yield
+                    // starts the next one, which the sleepers count
+                    int quantum = manager->getCurrentQuantum();
+                    coPollWaiters((quantum + MICROS_PER_MILLI - 1) / MICROS_PER_MILLI);
+                    manager->yieldThread();
+                }
+            }
+            unblockAlarm();
+            continue;
+        }
+        // one round over the tasks that are ready now, so woken tasks don't starve
+        for (size_t n = coReady.size(); n > 0; --n)
+        {
+            std::coroutine_handle<> h = coReady.front();
+            coReady.pop_front();
+            h.resume();
+            // every await returns here, which makes it a safe point for the host
+            uthread_checkpoint();
+        }
+    }
+}
+
+// the host runs as a closure thread so it learns when another uthread terminates it
+static void coHostRun(void *, bool call)
+{
+    if (!call) // terminated, with SIGVTALRM blocked: the next uthread_co_spawn spawns a new host
+    {
+        coHostTid = -1;
+        coHostParked = false;
+        return;
+    }
+    coHostMain();
+}
+
+int uthread_co_spawn(UCoTask task)
+{
+    std::coroutine_handle<> h = task.release();
+    if (manager->getCurrentTid() == coHostTid)
+    {
+        // spawned by another task, the host owns the ready queue
+        coReady.push_back(h);
+        return 0;
+    }
+
+    blockAlarm();
+    if (coHostTid == -1)
+    {
+        void *closure;
+        coHostTid = manager->createClosureThread(coHostRun, 0, &closure);
+        if (coHostTid == FAILURE)
+        {
+            unblockAlarm();
+            std::cerr << THREAD_LIB_ERR << CO_HOST_ERR << std::endl;
+            h.destroy();
+            return FAILURE;
+        }
+    }
+    coInbox.push_back(h);
+    if (coHostParked)
+    {
+        coHostParked = false;
+        manager->resumeThread(coHostTid);
+    }
+    unblockAlarm();
+    return 0;
+}
+
+UCoYield uthread_co_yield()
+{
+    return UCoYield();
+}
+
+UCoSleep uthread_co_sleep(int quantums)
+{
+    return UCoSleep{manager->getTotalQuants() + quantums};
+}
+
+UCoWaitFd uthread_co_wait_fd(int fd, short events)
+{
+    return UCoWaitFd{fd, events, 0, nullptr};
+}
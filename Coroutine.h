@@ -0,0 +1,309 @@
+//
+// Stackless uthread tasks built on C++20 coroutines.
+//
+
+#ifndef EX2_COROUTINE_H
+#define EX2_COROUTINE_H
+
+//------------------includes--------------------
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <cstddef>
+#include <poll.h>
+
+//--------------functions-------------------
+
+/**
+ * make a suspended coroutine ready to run again on the coroutine host
+ * @param handle the coroutine to wake
+ */
+void coMakeReady(std::coroutine_handle<> handle);
+
+/**
+ * park a coroutine until the total quantum count reaches wakeQuantum
+ * @param handle the coroutine to park
+ * @param wakeQuantum quantum at which the coroutine becomes ready
+ */
+void coSleepUntil(std::coroutine_handle<> handle, int wakeQuantum);
+
+/**
+ * allocate a coroutine frame with SIGVTALRM blocked, frames are made by any uthread and freed by
+ * the host, and a preemption inside the allocator would leave it to the other one half updated
+ * @param size
+ * @return the frame
+ */
+void *coAllocFrame(size_t size);
+
+/**
+ * free a frame from coAllocFrame, with SIGVTALRM blocked
+ * @param frame
+ */
+void coFreeFrame(void *frame);
+
+//---------------classes---------------------------
+
+/**
+ * The return type of a stackless uthread. A coroutine returning UCoTask is created suspended
+ * and only starts running once it is handed to uthread_co_spawn. Its frame is freed when it
+ * finishes.
+ */
+class UCoTask
+{
+public:
+    struct promise_type
+    {
+        UCoTask get_return_object()
+        {
+            return UCoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        { return {}; }
+
+        std::suspend_never final_suspend() noexcept
+        { return {}; }
+
+        void return_void()
+        {}
+
+        void unhandled_exception()
+        { std::terminate(); }
+
+        static void *operator new(size_t size)
+        { return coAllocFrame(size); }
+
+        static void operator delete(void *frame)
+        { coFreeFrame(frame); }
+    };
+
+    UCoTask(UCoTask &&other) noexcept : _handle(other._handle)
+    { other._handle = nullptr; }
+
+    UCoTask(const UCoTask &) = delete;
+
+    UCoTask &operator=(const UCoTask &) = delete;
+
+    /**
+     * destroys the coroutine frame if the task was never spawned
+     */
+    ~UCoTask()
+    {
+        if (_handle)
+        { _handle.destroy(); }
+    }
+
+    /**
+     * give up ownership of the coroutine, used when the task is handed to the scheduler
+     * @return the coroutine handle
+     */
+    std::coroutine_handle<> release()
+    {
+        std::coroutine_handle<> h = _handle;
+        _handle = nullptr;
+        return h;
+    }
+
+private:
+    explicit UCoTask(std::coroutine_handle<promise_type> handle) : _handle(handle)
+    {}
+
+    std::coroutine_handle<promise_type> _handle;
+};
+
+/**
+ * awaited to give up the host to the next ready coroutine
+ */
+struct UCoYield
+{
+    bool await_ready() const noexcept
+    { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    { coMakeReady(handle); }
+
+    void await_resume() const noexcept
+    {}
+};
+
+/**
+ * awaited to suspend the coroutine for a number of quantums
+ */
+struct UCoSleep
+{
+    int wakeQuantum;
+
+    bool await_ready() const noexcept;
+
+    void await_suspend(std::coroutine_handle<> handle)
+    { coSleepUntil(handle, wakeQuantum); }
+
+    void await_resume() const noexcept
+    {}
+};
+
+/**
+ * awaited to suspend the coroutine until a file descriptor becomes ready
+ */
+struct UCoWaitFd
+{
+    int fd;
+    short events;
+    short revents;
+    std::coroutine_handle<> handle;
+
+    bool await_ready() const noexcept
+    { return false; }
+
+    void await_suspend(std::coroutine_handle<> h);
+
+    /**
+     * @return the poll revents reported for fd
+     */
+    short await_resume() const noexcept
+    { return revents; }
+};
+
+/**
+ * A bounded channel between coroutines. Values are handed directly to a waiting receiver when
+ * there is one, otherwise they are buffered; a sender is suspended only when the buffer is full.
+ * Channels must only be used from coroutines, all of which run on the coroutine host.
+ */
+template<typename T>
+class UCoChannel
+{
+private:
+    struct Sender
+    {
+        std::coroutine_handle<> handle;
+        T *value;
+    };
+
+    struct Receiver
+    {
+        std::coroutine_handle<> handle;
+        std::optional<T> *slot;
+    };
+
+    std::deque<T> _buffer;
+    std::deque<Sender> _senders;
+    std::deque<Receiver> _receivers;
+    size_t _capacity;
+
+public:
+    class SendAwaiter
+    {
+    private:
+        UCoChannel &_channel;
+        T _value;
+
+    public:
+        SendAwaiter(UCoChannel &channel, T value) : _channel(channel), _value(std::move(value))
+        {}
+
+        bool await_ready()
+        {
+            if (!_channel._receivers.empty())
+            {
+                Receiver r = _channel._receivers.front();
+                _channel._receivers.pop_front();
+                r.slot->emplace(std::move(_value));
+                coMakeReady(r.handle);
+                return true;
+            }
+            if (_channel._buffer.size() < _channel._capacity)
+            {
+                _channel._buffer.push_back(std::move(_value));
+                return true;
+            }
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        { _channel._senders.push_back(Sender{handle, &_value}); }
+
+        void await_resume() const noexcept
+        {}
+    };
+
+    class RecvAwaiter
+    {
+    private:
+        UCoChannel &_channel;
+        std::optional<T> _slot;
+
+    public:
+        explicit RecvAwaiter(UCoChannel &channel) : _channel(channel)
+        {}
+
+        bool await_ready()
+        {
+            if (_channel._buffer.empty())
+            { return false; }
+            _slot.emplace(std::move(_channel._buffer.front()));
+            _channel._buffer.pop_front();
+            // a slot was freed, let the first blocked sender fill it
+            if (!_channel._senders.empty())
+            {
+                Sender s = _channel._senders.front();
+                _channel._senders.pop_front();
+                _channel._buffer.push_back(std::move(*s.value));
+                coMakeReady(s.handle);
+            }
+            return true;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        { _channel._receivers.push_back(Receiver{handle, &_slot}); }
+
+        T await_resume()
+        { return std::move(*_slot); }
+    };
+
+    /**
+     * @param capacity number of values buffered before senders are suspended, at least 1
+     */
+    explicit UCoChannel(size_t capacity = 1) : _capacity(capacity ? capacity : 1)
+    {}
+
+    /**
+     * @param value the value to send
+     * @return awaiter that completes once the value is buffered or handed to a receiver
+     */
+    SendAwaiter send(T value)
+    { return SendAwaiter(*this, std::move(value)); }
+
+    /**
+     * @return awaiter yielding the next value of the channel
+     */
+    RecvAwaiter recv()
+    { return RecvAwaiter(*this); }
+};
+
+/*
+ * Description: This function schedules a stackless task. All tasks run on a single coroutine
+ * host uthread which is spawned on first use and scheduled by the same ready queue as every
+ * other uthread. A task is suspended only at co_await points.
+ * Return value: On success, return 0. On failure (the host could not be spawned), return -1.
+*/
+int uthread_co_spawn(UCoTask task);
+
+/*
+ * Description: Awaited by a task to let the other ready tasks run.
+*/
+UCoYield uthread_co_yield();
+
+/*
+ * Description: Awaited by a task to suspend itself for the given number of quantums.
+*/
+UCoSleep uthread_co_sleep(int quantums);
+
+/*
+ * Description: Awaited by a task to suspend itself until fd is ready for the given poll events.
+ * Return value: the poll revents of fd.
+*/
+UCoWaitFd uthread_co_wait_fd(int fd, short events);
+
+#endif //EX2_COROUTINE_H
@@ -0,0 +1,76 @@
+//------------------includes--------------------
+#include <atomic>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "Idle.h"
+
+//------------------defines--------------------
+#define POST_WORD_BITS 64
+#define POST_WORDS ((MAX_THREAD_NUM + POST_WORD_BITS - 1) / POST_WORD_BITS)
+#define AWAKE 0
+#define PARKED 1
+
+//---------------global variables----------------
+// one bit per tid that was posted, so a burst of posts for one thread is one resume
+static std::atomic<uint64_t> idlePosts[POST_WORDS];
+static std::atomic<bool> idleAnyPosts(false);
+// the futex word: PARKED while the scheduler sleeps, posters flip it back and wake it once
+static std::atomic<int> idleParked(AWAKE);
+
+//--------------functions-------------------
+int idlePost(int tid)
+{
+    if (tid < 0 || tid >= MAX_THREAD_NUM)
+    { return -1; }
+    idlePosts[tid / POST_WORD_BITS].fetch_or(uint64_t(1) << (tid % POST_WORD_BITS));
+    idleAnyPosts.store(true);
+    // only the first post of a burst finds the scheduler parked, so it is woken once
+    if (idleParked.exchange(AWAKE) == PARKED)
+    {
+        syscall(SYS_futex, &idleParked, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+    return 0;
+}
+
+bool idleHasPosts()
+{
+    return idleAnyPosts.load(std::memory_order_relaxed);
+}
+
+int idleTakePosts(int *tidsOut)
+{
+    int n = 0;
+    idleAnyPosts.store(false);
+    for (int word = 0; word < POST_WORDS; ++word)
+    {
+        uint64_t bits = idlePosts[word].exchange(0);
+        while (bits != 0)
+        {
+            int bit = __builtin_ctzll(bits);
+            bits &= bits - 1;
+            tidsOut[n++] = word * POST_WORD_BITS + bit;
+        }
+    }
+    return n;
+}
+
+void idleWait(int spins)
+{
+    for (int i = 0; i < spins; ++i)
+    {
+        if (idleHasPosts())
+        { return; }
+        asm volatile("pause");
+    }
+    idleParked.store(PARKED);
+    // a post between the spin and the store above is seen here, or it flipped the word back
+    if (idleAnyPosts.load())
+    {
+        idleParked.store(AWAKE);
+        return;
+    }
+    syscall(SYS_futex, &idleParked, FUTEX_WAIT_PRIVATE, PARKED, nullptr, nullptr, 0);
+    idleParked.store(AWAKE);
+}
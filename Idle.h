@@ -0,0 +1,42 @@
+//
+// Parking the library's kernel thread while no uthread is ready, until another pthread or a
+// signal handler posts a resume.
+//
+
+#ifndef EX2_IDLE_H
+#define EX2_IDLE_H
+
+//------------------includes--------------------
+#include "uthreads.h"
+
+//--------------functions-------------------
+
+/**
+ * post tid to be resumed by the scheduler, waking it if it is parked. Lock free and async
+ * signal safe, so it may be called from any pthread and from signal handlers
+ * @param tid
+ * @return 0 on success, -1 if tid is out of range
+ */
+int idlePost(int tid);
+
+/**
+ *
+ * @return whether resumes were posted and not taken yet
+ */
+bool idleHasPosts();
+
+/**
+ * take the posted resumes
+ * @param tidsOut receives the posted tids, room for MAX_THREAD_NUM
+ * @return number of tids written
+ */
+int idleTakePosts(int *tidsOut);
+
+/**
+ * poll for posted resumes spins times, then sleep on a futex until one is posted. May return
+ * early on a signal, so callers check for posts again
+ * @param spins
+ */
+void idleWait(int spins);
+
+#endif //EX2_IDLE_H
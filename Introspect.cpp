@@ -0,0 +1,190 @@
+//------------------includes--------------------
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "Introspect.h"
+
+//------------------defines--------------------
+#define MICROS_PER_MILLI 1000
+
+//---------------global variables----------------
+static pthread_t introspectThread;
+static int introspectFd = -1;
+static std::string introspectPath;
+static SnapshotSeqlock *introspectSnapshot = nullptr;
+
+//------------------functions-------------------
+// the first write is made before any reader asks, so there is always a snapshot to copy
+SnapshotSeqlock::SnapshotSeqlock() : _seq(0), _wanted(true), _data()
+{
+}
+
+SchedulerSnapshot &SnapshotSeqlock::beginWrite()
+{
+    // odd while writing
+    _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return _data;
+}
+
+void SnapshotSeqlock::endWrite()
+{
+    _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    _wanted.store(false, std::memory_order_relaxed);
+}
+
+bool SnapshotSeqlock::wanted() const
+{
+    return _wanted.load(std::memory_order_relaxed);
+}
+
+void SnapshotSeqlock::readFresh(SchedulerSnapshot &out, int waitMs)
+{
+    unsigned int before = _seq.load(std::memory_order_acquire);
+    _wanted.store(true, std::memory_order_relaxed);
+    // the scheduler writes at its next switch or library call
+    for (int waited = 0; waited < waitMs && _seq.load(std::memory_order_acquire) == before;
+         ++waited)
+    {
+        usleep(MICROS_PER_MILLI);
+    }
+    read(out);
+}
+
+void SnapshotSeqlock::read(SchedulerSnapshot &out) const
+{
+    for (;;)
+    {
+        unsigned int before = _seq.load(std::memory_order_acquire);
+        if (before & 1u)
+        { continue; }
+        memcpy(&out, &_data, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_seq.load(std::memory_order_relaxed) == before)
+        { return; }
+    }
+}
+
+static const char *stateName(int state)
+{
+    switch (state)
+    {
+        case RUNNING:
+            return "RUNNING";
+        case BLOCKED:
+            return "BLOCKED";
+        default:
+            return "READY";
+    }
+}
+
+static std::string snapshotToJson(const SchedulerSnapshot &snap)
+{
+    char buf[256];
+    std::string json;
+    snprintf(buf, sizeof(buf), "{\"total_quantums\":%d,\"current_tid\":%d,\"num_threads\":%d,"
+                               "\"ready_queue_length\":%d,\"threads\":[",
+             snap.totalQuants, snap.currentTid, snap.numThreads, snap.readyLength);
+    json += buf;
+    bool first = true;
+    for (const ThreadSnapshot &t : snap.threads)
+    {
+        if (t.tid == NO_THREAD)
+        { continue; }
+        if (t.syncedWith == NO_THREAD)
+        {
+            snprintf(buf, sizeof(buf), "%s{\"tid\":%d,\"state\":\"%s\",\"quantums\":%d,"
+                                       "\"synced_with\":null,\"priority\":%d,\"group\":%d,"
+                                       "\"stack_high_water\":%d}",
+                     first ? "" : ",", t.tid, stateName(t.state), t.quants, t.priority,
+                     t.group, t.stackHighWater);
+        }
+        else
+        {
+            snprintf(buf, sizeof(buf), "%s{\"tid\":%d,\"state\":\"%s\",\"quantums\":%d,"
+                                       "\"synced_with\":%d,\"priority\":%d,\"group\":%d,"
+                                       "\"stack_high_water\":%d}",
+                     first ? "" : ",", t.tid, stateName(t.state), t.quants, t.syncedWith,
+                     t.priority, t.group, t.stackHighWater);
+        }
+        json += buf;
+        first = false;
+    }
+    json += "]}\n";
+    return json;
+}
+
+static void *introspectServe(void *)
+{
+    // the timer signal is for the uthreads, never take it on this thread
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, nullptr);
+
+    SchedulerSnapshot snap;
+    for (;;)
+    {
+        int client = accept(introspectFd, nullptr, nullptr);
+        if (client < 0)
+        {
+            return nullptr; // the socket was shut down
+        }
+        introspectSnapshot->readFresh(snap, INTROSPECT_WAIT_MS);
+        std::string json = snapshotToJson(snap);
+        size_t sent = 0;
+        while (sent < json.size())
+        {
+            ssize_t n = write(client, json.data() + sent, json.size() - sent);
+            if (n <= 0)
+            { break; }
+            sent += n;
+        }
+        close(client);
+    }
+}
+
+int introspectStart(const char *path, SnapshotSeqlock *snapshot)
+{
+    sockaddr_un addr;
+    if (introspectFd != -1 || strlen(path) >= sizeof(addr.sun_path))
+    { return -1; }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    { return -1; }
+    unlink(path);
+    if (bind(fd, (sockaddr *) &addr, sizeof(addr)) < 0 || listen(fd, 8) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    introspectFd = fd;
+    introspectPath = path;
+    introspectSnapshot = snapshot;
+    if (pthread_create(&introspectThread, nullptr, introspectServe, nullptr) != 0)
+    {
+        close(fd);
+        unlink(path);
+        introspectFd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void introspectStop()
+{
+    if (introspectFd == -1)
+    { return; }
+    shutdown(introspectFd, SHUT_RDWR); // wakes the pthread out of accept
+    pthread_join(introspectThread, nullptr);
+    close(introspectFd);
+    unlink(introspectPath.c_str());
+    introspectFd = -1;
+}
@@ -0,0 +1,101 @@
+//
+// Live view of the scheduler, served as JSON over a local Unix domain socket.
+//
+
+#ifndef EX2_INTROSPECT_H
+#define EX2_INTROSPECT_H
+
+//------------------includes--------------------
+#include <atomic>
+#include "Thread.h"
+
+//------------------defines--------------------
+#define NO_THREAD -1
+#define INTROSPECT_WAIT_MS 50 // longest a connection waits for a fresh snapshot
+
+//---------------structs---------------------------
+
+struct ThreadSnapshot
+{
+    int tid; // NO_THREAD for a free slot
+    int state;
+    int quants;
+    int syncedWith; // tid the thread waits for, NO_THREAD if it isn't synced
+    int priority;
+    int group;
+    int stackHighWater; // bytes of stack ever used, -1 if unknown
+};
+
+struct SchedulerSnapshot
+{
+    int totalQuants;
+    int currentTid;
+    int numThreads;
+    int readyLength;
+    ThreadSnapshot threads[MAX_THREAD_NUM];
+};
+
+//---------------class---------------------------
+
+/**
+ * A single writer seqlock around a SchedulerSnapshot. The scheduler writes without ever waiting,
+ * readers on other kernel threads retry until they copy a snapshot no write overlapped. The
+ * scheduler only writes when a reader asked for a snapshot, so it costs nothing with no client.
+ */
+class SnapshotSeqlock
+{
+private:
+    std::atomic<unsigned int> _seq;
+    std::atomic<bool> _wanted; // a reader waits for the next write
+    SchedulerSnapshot _data;
+
+public:
+    SnapshotSeqlock();
+
+    /**
+     * start a write, must be followed by endWrite
+     * @return the snapshot to fill
+     */
+    SchedulerSnapshot &beginWrite();
+
+    /**
+     * publish what was written since beginWrite
+     */
+    void endWrite();
+
+    /**
+     *
+     * @return whether a reader asked for a new snapshot since the last write
+     */
+    bool wanted() const;
+
+    /**
+     * ask the writer for a new snapshot and wait up to waitMs for it. Without one in time the
+     * previous snapshot is copied
+     * @param out
+     * @param waitMs
+     */
+    void readFresh(SchedulerSnapshot &out, int waitMs);
+
+    /**
+     * copy a consistent snapshot
+     * @param out
+     */
+    void read(SchedulerSnapshot &out) const;
+};
+
+/**
+ * start the pthread serving snapshots on a Unix domain socket at path. Every connection gets
+ * one JSON snapshot and is closed
+ * @param path
+ * @param snapshot the seqlock the scheduler publishes to
+ * @return 0 on success, -1 otherwise
+ */
+int introspectStart(const char *path, SnapshotSeqlock *snapshot);
+
+/**
+ * stop the serving pthread and remove the socket
+ */
+void introspectStop();
+
+#endif //EX2_INTROSPECT_H
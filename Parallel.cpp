@@ -0,0 +1,264 @@
+//------------------includes--------------------
+#include <atomic>
+#include <cstdint>
+#include "Scheduler.h"
+#include "Parallel.h"
+
+extern Scheduler *manager;
+
+//--------------ERRORS----------------------
+#define PARALLEL_RANGE_ERR "illegal parallel loop range"
+#define PARALLEL_WORKERS_ERR "illegal number of parallel workers"
+#define PARALLEL_WAIT_ERR "no thread is left to finish the parallel loop"
+#define PARALLEL_KILLED_ERR "a parallel helper was terminated, part of the loop may not have run"
+
+//------------------defines--------------------
+#define RANGE_MAX 0xffffffffUL // indices a loop may have, so a range packs into one word
+
+//---------------structs---------------------------
+struct ParallelLoop
+{
+    void (*body)(void *, int, long, long);
+    void *ctx;
+    long begin;
+    long grain;
+    int workers;
+    // what is left of every worker's range, relative to begin: lo in the high half, hi in the
+    // low half, so the owner and the thieves update it with one compare and swap
+    std::atomic<uint64_t> ranges[PARALLEL_MAX_WORKERS];
+    int active; // helpers still running, with SIGVTALRM blocked
+    int waiter; // tid of the caller blocked until the helpers are done, -1 if none
+    bool killed; // a helper was terminated, the chunk it was running is lost
+    int helperTids[PARALLEL_MAX_WORKERS]; // by slot, -1 once the helper is done
+};
+
+struct ParallelHelper
+{
+    ParallelLoop *loop;
+    int slot;
+};
+
+//---------------global variables----------------
+static int parallelWorkers = PARALLEL_DEFAULT_WORKERS;
+
+//--------------functions-------------------
+static uint64_t packRange(uint64_t lo, uint64_t hi)
+{
+    return (lo << 32) | hi;
+}
+
+// take up to grain indices from the front of the worker's own range
+static bool takeChunk(ParallelLoop *loop, int slot, long &lo, long &hi)
+{
+    uint64_t range = loop->ranges[slot].load();
+    for (;;)
+    {
+        uint64_t first = range >> 32, last = range & RANGE_MAX;
+        if (first >= last)
+        { return false; }
+        uint64_t taken = last - first < (uint64_t) loop->grain ? last - first : loop->grain;
+        if (loop->ranges[slot].compare_exchange_weak(range, packRange(first + taken, last)))
+        {
+            lo = loop->begin + (long) first;
+            hi = lo + (long) taken;
+            return true;
+        }
+    }
+}
+
+// move the back half of the largest range left into the worker's own, empty, range
+static bool stealHalf(ParallelLoop *loop, int slot)
+{
+    for (;;)
+    {
+        int victim = -1;
+        uint64_t victimRange = 0, most = (uint64_t) loop->grain;
+        for (int w = 0; w < loop->workers; ++w)
+        {
+            uint64_t range = loop->ranges[w].load();
+            uint64_t first = range >> 32, last = range & RANGE_MAX;
+            if (w != slot && first < last && last - first > most)
+            {
+                victim = w;
+                victimRange = range;
+                most = last - first;
+            }
+        }
+        if (victim == -1) // what is left is at most a chunk per worker, its owner runs it
+        { return false; }
+        uint64_t first = victimRange >> 32, last = victimRange & RANGE_MAX;
+        uint64_t middle = first + (last - first) / 2;
+        // a thief killed between shrinking the victim and publishing its half would lose it
+        //block signal
+        blockAlarm();
+        if (loop->ranges[victim].compare_exchange_strong(victimRange, packRange(first, middle)))
+        {
+            loop->ranges[slot].store(packRange(middle, last));
+            //unblock signal
+            unblockAlarm();
+            return true;
+        }
+        //unblock signal
+        unblockAlarm();
+    }
+}
+
+// run chunks of the worker's own range, stealing more until none is worth taking
+static void work(ParallelLoop *loop, int slot)
+{
+    long lo, hi;
+    do
+    {
+        while (takeChunk(loop, slot, lo, hi))
+        {
+            loop->body(loop->ctx, slot, lo, hi);
+        }
+    } while (stealHalf(loop, slot));
+}
+
+// called with SIGVTALRM blocked
+static void helperDone(ParallelLoop *loop, int slot)
+{
+    loop->helperTids[slot] = -1;
+    if (--loop->active == 0 && loop->waiter != -1)
+    {
+        manager->resumeThread(loop->waiter);
+    }
+}
+
+static void helperRun(void *self, bool call)
+{
+    ParallelHelper *helper = static_cast<ParallelHelper *>(self);
+    if (!call) // killed: the killer is inside the library already
+    {
+        helper->loop->killed = true;
+        helperDone(helper->loop, helper->slot);
+        return;
+    }
+    work(helper->loop, helper->slot);
+
+    //block signal
+    blockAlarm();
+    helperDone(helper->loop, helper->slot);
+    //unblock signal
+    unblockAlarm();
+}
+
+int parallelRun(long begin, long end, long grain, void (*body)(void *, int, long, long),
+                void *ctx)
+{
+    if (end < begin || (unsigned long) (end - begin) > RANGE_MAX)
+    {
+        std::cerr << THREAD_LIB_ERR << PARALLEL_RANGE_ERR << std::endl;
+        return FAILURE;
+    }
+    if (end == begin)
+    { return 0; }
+
+    //block signal
+    blockAlarm();
+    // on the scheduler's heap, not this stack: helpers killed after the caller still touch it
+    void *memory = schedulerArena().allocate(sizeof(ParallelLoop));
+    if (memory == nullptr)
+    {
+        //unblock signal
+        unblockAlarm();
+        std::cerr << SYS_ERROR << ALLOC_FAIL << std::endl;
+        return FAILURE;
+    }
+    ParallelLoop *loop = new(memory) ParallelLoop();
+    loop->body = body;
+    loop->ctx = ctx;
+    loop->begin = begin;
+    loop->workers = parallelWorkers;
+    loop->grain = grain > 0 ? grain : (end - begin) / (PARALLEL_SPLITS * loop->workers);
+    if (loop->grain < 1)
+    { loop->grain = 1; }
+    // work first: the caller owns the whole range, helpers only get what they steal
+    loop->ranges[0].store(packRange(0, (uint64_t) (end - begin)));
+    loop->active = 0;
+    loop->waiter = -1;
+    loop->killed = false;
+    for (int w = 0; w < PARALLEL_MAX_WORKERS; ++w)
+    {
+        loop->helperTids[w] = -1;
+    }
+    for (int w = 1; w < loop->workers; ++w)
+    {
+        void *closure;
+        int tid = manager->createClosureThread(helperRun, sizeof(ParallelHelper), &closure);
+        if (tid == FAILURE)
+        { break; } // no ids left, the workers there are do the rest
+        ParallelHelper *helper = static_cast<ParallelHelper *>(closure);
+        helper->loop = loop;
+        helper->slot = w;
+        loop->helperTids[w] = tid;
+        loop->active++;
+    }
+    //unblock signal
+    unblockAlarm();
+
+    work(loop, 0);
+
+    //block signal
+    blockAlarm();
+    int tid = manager->getCurrentTid();
+    int success = 0;
+    while (loop->active > 0)
+    {
+        loop->waiter = tid;
+        if (manager->blockThread(tid) == FAILURE)
+        {
+            std::cerr << THREAD_LIB_ERR << PARALLEL_WAIT_ERR << std::endl;
+            for (int w = 1; w < loop->workers; ++w)
+            {
+                if (loop->helperTids[w] != -1)
+                { manager->terminateThread(loop->helperTids[w]); }
+            }
+            success = FAILURE;
+        }
+    }
+    //unblock signal
+    unblockAlarm();
+
+    // a helper that was killed may have left part of its range, every slot is free by now
+    for (int w = 0; success == 0 && w < loop->workers; ++w)
+    {
+        long lo, hi;
+        while (takeChunk(loop, w, lo, hi))
+        {
+            body(ctx, w, lo, hi);
+        }
+    }
+    if (success == 0 && loop->killed)
+    {
+        std::cerr << THREAD_LIB_ERR << PARALLEL_KILLED_ERR << std::endl;
+        success = FAILURE;
+    }
+
+    //block signal
+    blockAlarm();
+    loop->~ParallelLoop();
+    schedulerArena().release(loop);
+    //unblock signal
+    unblockAlarm();
+    return success;
+}
+
+/*
+ * Description: This function sets how many threads share a parallel loop: the calling thread
+ * and workers - 1 helper threads, spawned once per loop. With workers == 1 loops run in the
+ * calling thread only. It is an error to call this function with workers < 1 or
+ * workers > PARALLEL_MAX_WORKERS.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_parallel_set_workers(int workers)
+{
+    if (workers < 1 || workers > PARALLEL_MAX_WORKERS)
+    {
+        std::cerr << THREAD_LIB_ERR << PARALLEL_WORKERS_ERR << std::endl;
+        return FAILURE;
+    }
+    parallelWorkers = workers;
+    return 0;
+}
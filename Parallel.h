@@ -0,0 +1,118 @@
+//
+// Parallel loops over uthreads. The calling thread runs the loop itself, a few helper uthreads
+// steal halves of the work that is left, so nothing is spawned or joined per chunk.
+//
+
+#ifndef EX2_PARALLEL_H
+#define EX2_PARALLEL_H
+
+//------------------includes--------------------
+#include <type_traits>
+#include <utility>
+#include "uthreads.h"
+
+//------------------defines--------------------
+#define PARALLEL_MAX_WORKERS 8     // the calling thread and its helpers
+#define PARALLEL_DEFAULT_WORKERS 4
+#define PARALLEL_SPLITS 8          // chunks per worker when the grain is chosen automatically
+
+//--------------functions-------------------
+
+/**
+ * run body over [begin, end) in chunks of at most grain indices, spread over the calling thread
+ * and helper threads
+ * @param begin
+ * @param end
+ * @param grain indices per chunk, <= 0 to choose from the length and the number of workers
+ * @param body called as body(ctx, worker, lo, hi) for every chunk, worker being a slot in
+ * [0, PARALLEL_MAX_WORKERS) that no other worker runs chunks with at the same time
+ * @param ctx
+ * @return 0 on success, -1 on failure
+ */
+int parallelRun(long begin, long end, long grain, void (*body)(void *, int, long, long),
+                void *ctx);
+
+/*
+ * Description: This function sets how many threads share a parallel loop: the calling thread
+ * and workers - 1 helper threads, spawned once per loop. With workers == 1 loops run in the
+ * calling thread only. It is an error to call this function with workers < 1 or
+ * workers > PARALLEL_MAX_WORKERS.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_parallel_set_workers(int workers);
+
+/*
+ * Description: This function calls fn(i) for every i in [begin, end), in chunks of grain
+ * indices (chosen from the length of the range when grain <= 0). The calling thread starts
+ * with the whole range and helper threads steal the back half of the largest range that is
+ * left, so the work is split only as far as the workers need it. The function returns once
+ * every call returned. Helpers that can't be spawned for lack of thread ids are done without.
+ * If another thread terminates a helper, what is left of the helper's range is still run, but
+ * the chunk the helper was running may be cut short. It is an error to call this function with
+ * end - begin of 2^32 or more.
+ * Return value: On success, return 0. On failure (bad range, a helper was terminated, or the
+ * calling thread would wait for helpers that no other thread could ever let finish), return -1.
+*/
+template<typename F>
+int uthread_parallel_for(long begin, long end, long grain, F &&fn)
+{
+    typedef typename std::remove_reference<F>::type Fn;
+    return parallelRun(begin, end, grain, [](void *ctx, int, long lo, long hi)
+    {
+        Fn &f = *static_cast<Fn *>(ctx);
+        for (long i = lo; i < hi; ++i)
+        { f(i); }
+    }, (void *) &fn);
+}
+
+/**
+ * the state uthread_parallel_reduce shares with its chunks: one partial result per worker
+ */
+template<typename T, typename Map, typename Combine>
+struct ParallelReduction
+{
+    Map &map;
+    Combine &combine;
+    T partial[PARALLEL_MAX_WORKERS];
+
+    ParallelReduction(Map &m, Combine &c, const T &identity) : map(m), combine(c)
+    {
+        for (int w = 0; w < PARALLEL_MAX_WORKERS; ++w)
+        { partial[w] = identity; }
+    }
+
+    static void run(void *ctx, int worker, long lo, long hi)
+    {
+        ParallelReduction *r = static_cast<ParallelReduction *>(ctx);
+        T acc = std::move(r->partial[worker]);
+        for (long i = lo; i < hi; ++i)
+        { acc = r->combine(std::move(acc), r->map(i)); }
+        r->partial[worker] = std::move(acc);
+    }
+};
+
+/*
+ * Description: This function reduces map(i) over every i in [begin, end) with combine,
+ * starting from identity, and stores the result in *result. The range is split as by
+ * uthread_parallel_for and every worker keeps a partial result; these are combined at the end.
+ * Chunks reach a worker in no particular order, so combine has to be associative and
+ * commutative.
+ * Return value: On success, return 0. On failure, return -1 and *result is left as it was.
+*/
+template<typename T, typename Map, typename Combine>
+int uthread_parallel_reduce(long begin, long end, long grain, const T &identity, Map &&map,
+                            Combine &&combine, T *result)
+{
+    typedef ParallelReduction<T, typename std::remove_reference<Map>::type,
+            typename std::remove_reference<Combine>::type> Reduction;
+    Reduction reduction(map, combine, identity);
+    if (parallelRun(begin, end, grain, &Reduction::run, &reduction) == -1)
+    { return -1; }
+    T acc = identity;
+    for (int w = 0; w < PARALLEL_MAX_WORKERS; ++w)
+    { acc = combine(std::move(acc), std::move(reduction.partial[w])); }
+    *result = std::move(acc);
+    return 0;
+}
+
+#endif //EX2_PARALLEL_H
@@ -0,0 +1,355 @@
+//------------------includes--------------------
+#include <algorithm>
+#include <vector>
+#include "Scheduler.h"
+#include "Capture.h"
+#include "Replay.h"
+
+extern Scheduler *manager;
+
+//--------------ERRORS----------------------
+#define REPLAY_FILE_ERR "capture file could not be read"
+#define REPLAY_RUNNING_ERR "a replay is running already"
+
+//------------------defines--------------------
+#define NO_ACTOR -1
+#define PERCENT 100
+
+// what keeps an actor from running, besides the scheduler
+#define ACTOR_RUNNABLE 0
+#define ACTOR_SELF_BLOCKED 1
+#define ACTOR_BLOCKED 2 // by another actor
+
+//---------------structs---------------------------
+
+/**
+ * one captured thread, from its spawn to its end. A tid the capture reuses is a new actor
+ */
+struct ReplayActor
+{
+    std::vector<size_t> script; // its records, in order
+    int liveTid;                // NO_THREAD unless it runs now
+    int state;                  // ACTOR_*
+    int earlyResumes;           // resumes replayed before the block they were meant for
+    uint64_t readySince;        // when it was last made READY, for the latency of its wakeup
+    bool preexisting;           // spawned before the capture started, so at the replay's start
+};
+
+//---------------global variables----------------
+// the replay running, all of it used with SIGVTALRM blocked
+static bool replayRunning = false;
+static bool replayOver;
+static std::vector<CaptureRecord> replayRecords;
+static std::vector<int> replayTargets; // actor every record's target is, NO_ACTOR if none
+static std::vector<ReplayActor> replayActors;
+static int replayActorOf[MAX_THREAD_NUM]; // by live tid
+static long replayCalls;
+static std::vector<uint64_t> replayLatencies;
+
+//--------------functions-------------------
+
+// the actor a captured tid is when the capture refers to it, one is made up for a thread the
+// capture never saw spawned
+static int actorFor(int tid, std::vector<int> &actorOfTid)
+{
+    if (actorOfTid[tid] == NO_ACTOR)
+    {
+        actorOfTid[tid] = (int) replayActors.size();
+        replayActors.push_back(ReplayActor());
+        replayActors.back().preexisting = true;
+    }
+    return actorOfTid[tid];
+}
+
+// split the records into the scripts of the actors, following the tids through the capture
+static void buildActors()
+{
+    std::vector<int> actorOfTid(MAX_THREAD_NUM, NO_ACTOR);
+    replayActors.assign(1, ReplayActor()); // actor 0 is the main thread
+    actorOfTid[MAIN_TID] = 0;
+    replayTargets.assign(replayRecords.size(), NO_ACTOR);
+    for (size_t i = 0; i < replayRecords.size(); ++i)
+    {
+        const CaptureRecord &r = replayRecords[i];
+        if (r.caller < 0 || r.caller >= MAX_THREAD_NUM || r.target < 0 ||
+            r.target >= MAX_THREAD_NUM)
+        { continue; }
+        int caller = actorFor(r.caller, actorOfTid);
+        replayActors[caller].script.push_back(i);
+        if (r.op == CAPTURE_SPAWN)
+        {
+            actorOfTid[r.target] = (int) replayActors.size();
+            replayActors.push_back(ReplayActor());
+        }
+        replayTargets[i] = actorFor(r.target, actorOfTid);
+        if ((r.op == CAPTURE_EXIT || r.op == CAPTURE_TERMINATE) && r.target != MAIN_TID)
+        { actorOfTid[r.target] = NO_ACTOR; } // the tid may be spawned again, as a new actor
+    }
+    for (ReplayActor &actor : replayActors)
+    {
+        actor.liveTid = NO_THREAD;
+        actor.state = ACTOR_RUNNABLE;
+        actor.earlyResumes = 0;
+        actor.readySince = 0;
+    }
+}
+
+// spin until the calling thread ran usecs more, as the scheduler charges it: time it held the
+// cpu, the same measure the capture took its bursts with, so time spent preempted is left out
+static void spin(long usecs)
+{
+    //block signal
+    blockAlarm();
+    int self = manager->getCurrentTid();
+    long until = manager->getThreadRunUsecs(self) + usecs;
+    //unblock signal
+    unblockAlarm();
+    long ran;
+    do
+    {
+        //block signal
+        blockAlarm();
+        ran = manager->getThreadRunUsecs(self);
+        //unblock signal
+        unblockAlarm();
+    } while (ran < until);
+}
+
+static void addLatency(int actor)
+{
+    if (replayLatencies.size() < replayLatencies.capacity())
+    {
+        replayLatencies.push_back(captureNow() - replayActors[actor].readySince);
+    }
+}
+
+static void runActor(int self);
+
+static void actorThreadMain()
+{
+    //block signal
+    blockAlarm();
+    int self = replayActorOf[manager->getCurrentTid()];
+    addLatency(self);
+    //unblock signal
+    unblockAlarm();
+
+    runActor(self);
+
+    //block signal
+    blockAlarm();
+    replayActorOf[replayActors[self].liveTid] = NO_ACTOR;
+    replayActors[self].liveTid = NO_THREAD;
+    //unblock signal
+    unblockAlarm();
+}
+
+// spawn the actor's thread, with SIGVTALRM blocked
+static void startActor(int actor)
+{
+    int tid = manager->createNewThread(actorThreadMain);
+    if (tid == FAILURE)
+    { return; }
+    replayActors[actor].liveTid = tid;
+    replayActors[actor].readySince = captureNow();
+    replayActorOf[tid] = actor;
+}
+
+// replay one call of actor self on target, with SIGVTALRM blocked
+// @return false if self is done
+static bool replayCall(int self, int op, int target)
+{
+    ReplayActor &t = replayActors[target];
+    bool onSelf = target == self;
+    if (op == CAPTURE_EXIT || (op == CAPTURE_TERMINATE && onSelf))
+    { return false; }
+    if (op == CAPTURE_SPAWN)
+    {
+        if (t.liveTid == NO_THREAD)
+        { startActor(target); }
+        return true;
+    }
+    if (op == CAPTURE_YIELD)
+    {
+        replayActors[self].readySince = captureNow();
+        manager->yieldThread();
+        addLatency(self);
+        return true;
+    }
+    if (target == 0 && op == CAPTURE_TERMINATE) // the captured process ended
+    {
+        replayOver = true;
+        if (t.state != ACTOR_RUNNABLE)
+        {
+            t.state = ACTOR_RUNNABLE;
+            manager->resumeThread(t.liveTid);
+        }
+        return false;
+    }
+    if (t.liveTid == NO_THREAD) // not spawned, or gone already, in this run
+    { return true; }
+
+    switch (op)
+    {
+        case CAPTURE_TERMINATE:
+            replayActorOf[t.liveTid] = NO_ACTOR;
+            manager->terminateThread(t.liveTid);
+            t.liveTid = NO_THREAD;
+            break;
+        case CAPTURE_BLOCK:
+            if (onSelf && t.earlyResumes > 0)
+            {
+                t.earlyResumes--;
+            }
+            else if (onSelf)
+            {
+                t.state = ACTOR_SELF_BLOCKED;
+                if (manager->blockThread(t.liveTid) == 0)
+                { addLatency(self); }
+                t.state = ACTOR_RUNNABLE;
+            }
+            else if (t.state == ACTOR_RUNNABLE)
+            {
+                t.state = ACTOR_BLOCKED;
+                manager->blockThread(t.liveTid);
+            }
+            break;
+        case CAPTURE_RESUME:
+            if (t.state == ACTOR_RUNNABLE)
+            {
+                t.earlyResumes++;
+            }
+            else
+            {
+                t.state = ACTOR_RUNNABLE;
+                t.readySince = captureNow();
+                manager->resumeThread(t.liveTid);
+            }
+            break;
+        case CAPTURE_SYNC:
+            if (!onSelf)
+            { manager->syncThread(t.liveTid); }
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+// run the actor's script, each call after the cpu time that preceded it
+static void runActor(int self)
+{
+    const std::vector<size_t> &script = replayActors[self].script;
+    for (size_t k = 0; k < script.size(); ++k)
+    {
+        const CaptureRecord &r = replayRecords[script[k]];
+        spin((long) r.burstUs);
+
+        //block signal
+        blockAlarm();
+        if (replayOver)
+        {
+            unblockAlarm();
+            return;
+        }
+        replayCalls++;
+        bool goOn = replayCall(self, r.op, replayTargets[script[k]]);
+        //unblock signal
+        unblockAlarm();
+        if (!goOn)
+        { return; }
+    }
+}
+
+static uint64_t percentile(const std::vector<uint64_t> &sorted, int percent)
+{
+    if (sorted.empty())
+    { return 0; }
+    return sorted[(sorted.size() - 1) * percent / PERCENT];
+}
+
+/*
+ * Description: This function replays the capture at path. Every captured thread is spawned again
+ * when its spawn is replayed and makes the same calls in the same order, each after spinning for
+ * the CPU time the thread ran before the call (time it held the CPU, so time it spends preempted
+ * does not count). The threads are mapped to the ids they get now, and calls on a thread that does
+ * not exist at that point are skipped; a resume that comes before the block it was meant for lets
+ * that block through. The calling thread plays the captured main thread, and the replay ends with
+ * the main thread's last call, or once any thread's terminate of the main thread is replayed;
+ * captured threads still alive then are terminated. The library is used as configured by the caller
+ * (uthread_init or uthread_init_cooperative, quantums, policies, groups are not replayed).
+ * Return value: On success, return 0 and fill report. On failure (the file can't be read or is
+ * not a capture, or a replay is running), return -1.
+*/
+int uthread_replay(const char *path, uthread_replay_report_t *report)
+{
+    //block signal
+    blockAlarm();
+    if (replayRunning)
+    {
+        unblockAlarm();
+        std::cerr << THREAD_LIB_ERR << REPLAY_RUNNING_ERR << std::endl;
+        return FAILURE;
+    }
+    replayRunning = true;
+    //unblock signal
+    unblockAlarm();
+
+    CaptureHeader header;
+    if (captureRead(path, header, replayRecords) == FAILURE)
+    {
+        replayRunning = false;
+        std::cerr << THREAD_LIB_ERR << REPLAY_FILE_ERR << std::endl;
+        return FAILURE;
+    }
+    buildActors();
+    replayLatencies.clear();
+    replayLatencies.reserve(replayRecords.size() + replayActors.size());
+
+    //block signal
+    blockAlarm();
+    std::fill(replayActorOf, replayActorOf + MAX_THREAD_NUM, NO_ACTOR);
+    replayOver = false;
+    replayCalls = 0;
+    int quantums = manager->getTotalQuants();
+    uint64_t start = captureNow();
+    replayActors[0].liveTid = manager->getCurrentTid();
+    replayActorOf[replayActors[0].liveTid] = 0;
+    for (size_t a = 1; a < replayActors.size(); ++a)
+    {
+        if (replayActors[a].preexisting)
+        { startActor((int) a); }
+    }
+    //unblock signal
+    unblockAlarm();
+
+    runActor(0);
+
+    //block signal
+    blockAlarm();
+    for (size_t a = 1; a < replayActors.size(); ++a)
+    {
+        if (replayActors[a].liveTid != NO_THREAD)
+        {
+            replayActorOf[replayActors[a].liveTid] = NO_ACTOR;
+            manager->terminateThread(replayActors[a].liveTid);
+            replayActors[a].liveTid = NO_THREAD;
+        }
+    }
+    replayActorOf[replayActors[0].liveTid] = NO_ACTOR;
+    report->seconds = (captureNow() - start) / 1e9;
+    report->quantums = manager->getTotalQuants() - quantums;
+    report->calls = replayCalls;
+    //unblock signal
+    unblockAlarm();
+
+    report->callsPerSecond = report->seconds > 0 ? report->calls / report->seconds : 0;
+    std::sort(replayLatencies.begin(), replayLatencies.end());
+    report->latencySamples = (long) replayLatencies.size();
+    report->latencyP50Ns = percentile(replayLatencies, 50);
+    report->latencyP90Ns = percentile(replayLatencies, 90);
+    report->latencyP99Ns = percentile(replayLatencies, 99);
+    report->latencyMaxNs = replayLatencies.empty() ? 0 : replayLatencies.back();
+    replayRunning = false;
+    return 0;
+}
@@ -0,0 +1,50 @@
+//
+// Replaying a workload captured by uthread_capture_start against whatever configuration the
+// library runs with, measuring how the scheduler handles it.
+//
+
+#ifndef EX2_REPLAY_H
+#define EX2_REPLAY_H
+
+//------------------includes--------------------
+#include <cstdint>
+
+//---------------structs---------------------------
+
+/**
+ * What a replay measured. Run queue latency is the time from a thread being made READY by a
+ * spawn, a resume or its own yield, to it running again.
+ */
+struct ReplayReport
+{
+    long calls;             // captured calls replayed
+    double seconds;         // wall time of the replay
+    double callsPerSecond;
+    int quantums;           // quantums started during the replay, one per switch
+    long latencySamples;
+    uint64_t latencyP50Ns;
+    uint64_t latencyP90Ns;
+    uint64_t latencyP99Ns;
+    uint64_t latencyMaxNs;
+};
+
+typedef ReplayReport uthread_replay_report_t;
+
+//--------------functions-------------------
+
+/*
+ * Description: This function replays the capture at path. Every captured thread is spawned again
+ * when its spawn is replayed and makes the same calls in the same order, each after spinning for
+ * the CPU time the thread ran before the call (time it held the CPU, so time it spends preempted
+ * does not count). The threads are mapped to the ids they get now, and calls on a thread that does
+ * not exist at that point are skipped; a resume that comes before the block it was meant for lets
+ * that block through. The calling thread plays the captured main thread, and the replay ends with
+ * the main thread's last call, or once any thread's terminate of the main thread is replayed;
+ * captured threads still alive then are terminated. The library is used as configured by the caller
+ * (uthread_init or uthread_init_cooperative, quantums, policies, groups are not replayed).
+ * Return value: On success, return 0 and fill report. On failure (the file can't be read or is
+ * not a capture, or a replay is running), return -1.
+*/
+int uthread_replay(const char *path, uthread_replay_report_t *report);
+
+#endif //EX2_REPLAY_H
@@ -0,0 +1,270 @@
+//
+// Building blocks a BasicScheduler is instantiated with: how the quantum timer is driven and
+// how the ready threads are kept.
+//
+
+#ifndef EX2_SCHEDULERPOLICY_H
+#define EX2_SCHEDULERPOLICY_H
+
+//------------------includes--------------------
+#include <cstdint>
+#include <iterator>
+#include <signal.h>
+#include <sys/time.h>
+#include "Thread.h"
+
+//------------------defines--------------------
+#define MICRO_SECS 1000000
+#define READY_WORD_BITS 64
+
+//---------------classes---------------------------
+
+/**
+ * Quantums timed by ITIMER_VIRTUAL, delivering SIGVTALRM. Whether the timer is used at all is
+ * decided when the scheduler is constructed, so one instantiation serves both uthread_init and
+ * uthread_init_cooperative.
+ */
+class ItimerBackend
+{
+private:
+    struct itimerval _timer;
+    bool _preemptive; // false: no timer, threads switch only when they yield, block or sync
+    int _armedUsecs;  // interval the timer runs with, 0 when stopped
+
+    void _set(int usecs)
+    {
+        _timer.it_value.tv_sec = usecs / MICRO_SECS;
+        _timer.it_value.tv_usec = usecs % MICRO_SECS;
+        _timer.it_interval = _timer.it_value;
+        _armedUsecs = usecs;
+        // Start a virtual timer. It counts down whenever this process is executing.
+        if (setitimer(ITIMER_VIRTUAL, &_timer, NULL))
+        {
+            std::cerr << SYS_ERROR << TIMER_ERR << std::endl;
+        }
+    }
+
+public:
+    explicit ItimerBackend(bool preemptive) : _timer(), _preemptive(preemptive), _armedUsecs(0)
+    {}
+
+    /**
+     *
+     * @return whether threads are preempted by the timer
+     */
+    bool isPreemptive() const
+    { return _preemptive; }
+
+    /**
+     *
+     * @return interval the timer runs with in micro-seconds, 0 when stopped
+     */
+    int armed() const
+    { return _armedUsecs; }
+
+    /**
+     * start/restart the timer
+     * @param usecs quantum in micro-seconds
+     */
+    void start(int usecs)
+    {
+        if (_preemptive)
+        { _set(usecs); }
+    }
+
+    void stop()
+    {
+        if (_preemptive)
+        { _set(0); }
+    }
+
+    /**
+     * block SIGVTALRM for the calling thread, when the timer is used
+     */
+    void mask() const
+    {
+        if (!_preemptive)
+        { return; }
+        sigset_t alarm;
+        sigemptyset(&alarm);
+        sigaddset(&alarm, SIGVTALRM);
+        sigprocmask(SIG_BLOCK, &alarm, nullptr);
+    }
+
+    /**
+     * unblock SIGVTALRM for the calling thread, when the timer is used
+     */
+    void unmask() const
+    {
+        if (!_preemptive)
+        { return; }
+        sigset_t alarm;
+        sigemptyset(&alarm);
+        sigaddset(&alarm, SIGVTALRM);
+        sigprocmask(SIG_UNBLOCK, &alarm, nullptr);
+    }
+};
+
+/**
+ * No timer: a cooperative scheduler, where every timer operation compiles away.
+ */
+class NoTimerBackend
+{
+public:
+    explicit NoTimerBackend(bool)
+    {}
+
+    bool isPreemptive() const
+    { return false; }
+
+    int armed() const
+    { return 0; }
+
+    void start(int)
+    {}
+
+    void stop()
+    {}
+
+    void mask() const
+    {}
+
+    void unmask() const
+    {}
+};
+
+/**
+ * A ready set of at most MaxThreads threads kept as a bitmap indexed by tid, with the
+ * interface of the std::deque the default scheduler uses. Iteration starts right after the
+ * last thread that was taken out, so taking the first thread is round robin by tid. Adding,
+ * removing and finding a thread are O(1) and nothing is allocated.
+ */
+template<int MaxThreads>
+class BitmapReadySet
+{
+private:
+    static const int WORDS = (MaxThreads + READY_WORD_BITS - 1) / READY_WORD_BITS;
+
+    uint64_t _bits[WORDS];
+    Thread *_threads[MaxThreads];
+    int _cursor; // tid iteration starts at
+    int _size;
+
+    bool _has(int tid) const
+    { return (_bits[tid / READY_WORD_BITS] >> (tid % READY_WORD_BITS)) & 1; }
+
+public:
+    /**
+     * walks the set tids from the cursor around to just before it
+     */
+    class iterator
+    {
+    private:
+        const BitmapReadySet *_set;
+        int _offset; // from the cursor, MaxThreads at the end
+
+        void _skipEmpty()
+        {
+            while (_offset < MaxThreads && !_set->_has(tid()))
+            { _offset++; }
+        }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Thread *value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Thread *const *pointer;
+        typedef Thread *const &reference;
+
+        iterator(const BitmapReadySet *set, int offset) : _set(set), _offset(offset)
+        { _skipEmpty(); }
+
+        int tid() const
+        { return (_set->_cursor + _offset) % MaxThreads; }
+
+        reference operator*() const
+        { return _set->_threads[tid()]; }
+
+        iterator &operator++()
+        {
+            _offset++;
+            _skipEmpty();
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator &other) const
+        { return _offset == other._offset; }
+
+        bool operator!=(const iterator &other) const
+        { return _offset != other._offset; }
+    };
+
+    typedef iterator const_iterator;
+
+    BitmapReadySet() : _bits(), _threads(), _cursor(0), _size(0)
+    {}
+
+    iterator begin() const
+    { return iterator(this, 0); }
+
+    iterator end() const
+    { return iterator(this, MaxThreads); }
+
+    iterator cbegin() const
+    { return begin(); }
+
+    iterator cend() const
+    { return end(); }
+
+    bool empty() const
+    { return _size == 0; }
+
+    size_t size() const
+    { return (size_t) _size; }
+
+    Thread *front() const
+    { return *begin(); }
+
+    /**
+     * add tp, a thread that is already in the set stays where it is
+     * @param tp
+     */
+    void push_back(Thread *tp)
+    {
+        int tid = tp->getId();
+        if (_has(tid))
+        { return; }
+        _bits[tid / READY_WORD_BITS] |= uint64_t(1) << (tid % READY_WORD_BITS);
+        _threads[tid] = tp;
+        _size++;
+    }
+
+    template<typename InputIt>
+    void insert(iterator, InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+        { push_back(*first); }
+    }
+
+    /**
+     * take the thread at pos out, iteration goes on from the thread after it
+     * @param pos
+     */
+    void erase(iterator pos)
+    {
+        int tid = pos.tid();
+        _bits[tid / READY_WORD_BITS] &= ~(uint64_t(1) << (tid % READY_WORD_BITS));
+        _threads[tid] = nullptr;
+        _size--;
+        _cursor = (tid + 1) % MaxThreads;
+    }
+};
+
+#endif //EX2_SCHEDULERPOLICY_H
@@ -0,0 +1,132 @@
+//
+// Spawning uthreads that run any callable with arguments. The callable and its arguments are
+// moved into a closure at the top of the new thread's own stack, so a spawn allocates nothing
+// besides the thread itself.
+//
+
+#ifndef EX2_SPAWN_H
+#define EX2_SPAWN_H
+
+//------------------includes--------------------
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "uthreads.h"
+
+//------------------defines--------------------
+#define SPAWN_CLOSURE_MAX (STACK_SIZE / 4) // largest closure kept on a thread's stack
+#define SPAWN_CLOSURE_ALIGN 16             // same as CLOSURE_ALIGN in Thread.h
+
+//--------------functions-------------------
+
+/**
+ * lock the library and create a thread that will run closureRun on a closureSize bytes closure
+ * at the top of its stack. On success the library stays locked until spawnClosureEnd, so the
+ * closure can be constructed before the thread runs
+ * @param closureRun
+ * @param closureSize
+ * @param tidOut receives the new thread's id, -1 on failure
+ * @return where to construct the closure, nullptr on failure
+ */
+void *spawnClosureBegin(void (*closureRun)(void *, bool), size_t closureSize, int *tidOut);
+
+/**
+ * unlock the library after a successful spawnClosureBegin, once the closure is constructed
+ * @param tid the new thread's id
+ */
+void spawnClosureEnd(int tid);
+
+/**
+ * take the thread of a successful spawnClosureBegin back, without running or destroying its
+ * closure, and unlock the library. For a closure whose constructor threw
+ * @param tid the new thread's id
+ */
+void spawnClosureAbort(int tid);
+
+//---------------classes---------------------------
+
+template<size_t... I>
+struct SpawnIndices
+{
+};
+
+template<size_t N, size_t... I>
+struct SpawnIndicesFor : SpawnIndicesFor<N - 1, N - 1, I...>
+{
+};
+
+template<size_t... I>
+struct SpawnIndicesFor<0, I...>
+{
+    typedef SpawnIndices<I...> type;
+};
+
+/**
+ * A callable with its arguments, run once by the thread whose stack holds it
+ */
+template<typename F, typename... Args>
+class SpawnClosure
+{
+private:
+    F _f;
+    std::tuple<Args...> _args;
+
+    template<size_t... I>
+    void _call(SpawnIndices<I...>)
+    { _f(std::move(std::get<I>(_args))...); }
+
+public:
+    template<typename G, typename... A>
+    explicit SpawnClosure(G &&f, A &&... args) : _f(std::forward<G>(f)),
+                                                 _args(std::forward<A>(args)...)
+    {}
+
+    /**
+     * call the callable and destroy the closure, the thread's entry point
+     * @param self the closure
+     * @param call false to only destroy the closure, when the thread is killed before it ends
+     */
+    static void run(void *self, bool call)
+    {
+        SpawnClosure *closure = static_cast<SpawnClosure *>(self);
+        if (call)
+        { closure->_call(typename SpawnIndicesFor<sizeof...(Args)>::type()); }
+        closure->~SpawnClosure();
+    }
+};
+
+/*
+ * Description: This function creates a new thread, like uthread_spawn(void (*f)(void)), that
+ * runs f(args...). f and args are moved (or copied) into the new thread's stack, not the heap;
+ * together they may take up to SPAWN_CLOSURE_MAX bytes. When f returns, the thread terminates
+ * as if it called uthread_terminate with its own ID. If moving or copying f or args throws, no
+ * thread is created and the exception is passed on.
+ * Return value: On success, return the ID of the created thread. On failure, return -1.
+*/
+template<typename F, typename... Args>
+int uthread_spawn(F &&f, Args &&... args)
+{
+    typedef SpawnClosure<typename std::decay<F>::type, typename std::decay<Args>::type...> Closure;
+    static_assert(sizeof(Closure) <= SPAWN_CLOSURE_MAX, "closure too large for a thread stack");
+    static_assert(alignof(Closure) <= SPAWN_CLOSURE_ALIGN, "closure alignment not supported");
+
+    int tid;
+    void *closure = spawnClosureBegin(&Closure::run, sizeof(Closure), &tid);
+    if (closure == nullptr)
+    { return tid; }
+    try
+    {
+        new(closure) Closure(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        spawnClosureAbort(tid);
+        throw;
+    }
+    spawnClosureEnd(tid);
+    return tid;
+}
+
+#endif //EX2_SPAWN_H
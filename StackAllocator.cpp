@@ -0,0 +1,97 @@
+//------------------includes--------------------
+#include <new>
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "StackAllocator.h"
+
+//------------------defines--------------------
+#define MPOL_PREFERRED 1 // from linux/mempolicy.h, so we don't depend on libnuma headers
+#define NODE_MASK_BITS (8 * sizeof(unsigned long))
+
+int StackAllocator::_node = -1;
+bool StackAllocator::_paint = false;
+
+//------------------functions-------------------
+char *StackAllocator::allocate(size_t size, bool &mapped)
+{
+    mapped = _node >= 0;
+    if (!mapped)
+    {
+        char *stack = new char[size];
+        if (_paint)
+        { memset(stack, STACK_PAINT, size); }
+        return stack;
+    }
+
+    void *stack = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stack == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    placeLocal(stack, size);
+    if (_paint)
+    { memset(stack, STACK_PAINT, size); }
+    return (char *) stack;
+}
+
+void StackAllocator::placeLocal(void *memory, size_t size)
+{
+    if (_node < 0)
+    { return; }
+    if ((size_t) _node < NODE_MASK_BITS)
+    {
+        // a kernel without NUMA support fails here, first touch below still keeps it local
+        unsigned long nodeMask = 1UL << _node;
+        syscall(SYS_mbind, memory, size, MPOL_PREFERRED, &nodeMask, NODE_MASK_BITS, 0);
+    }
+    long pageSize = sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < size; offset += pageSize)
+    {
+        ((volatile char *) memory)[offset] = 0;
+    }
+}
+
+void StackAllocator::release(char *stack, size_t size, bool mapped)
+{
+    if (stack == nullptr)
+    { return; }
+    if (!mapped)
+    {
+        delete[] stack;
+        return;
+    }
+    munmap(stack, size);
+}
+
+void StackAllocator::setNode(int node)
+{
+    _node = node;
+}
+
+int StackAllocator::getNode()
+{
+    return _node;
+}
+
+void StackAllocator::setPaint(bool paint)
+{
+    _paint = paint;
+}
+
+bool StackAllocator::isPainting()
+{
+    return _paint;
+}
+
+size_t StackAllocator::usedBytes(const char *stack, size_t size)
+{
+    // stacks grow down, so the untouched part is at the bottom
+    size_t untouched = 0;
+    while (untouched < size && (unsigned char) stack[untouched] == STACK_PAINT)
+    {
+        untouched++;
+    }
+    return size - untouched;
+}
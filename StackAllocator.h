@@ -0,0 +1,81 @@
+//
+// Allocation of uthread stacks, optionally bound to the NUMA node the library runs on.
+//
+
+#ifndef EX2_STACKALLOCATOR_H
+#define EX2_STACKALLOCATOR_H
+
+//------------------includes--------------------
+#include <cstddef>
+
+//------------------defines--------------------
+#define STACK_PAINT 0xa5
+
+//---------------class---------------------------
+
+class StackAllocator
+{
+private:
+    static int _node; // preferred NUMA node, -1 when placement is off
+    static bool _paint; // fill new stacks with STACK_PAINT to measure their use
+
+public:
+    /**
+     * allocate a stack. When a node was set the stack is mapped on its own pages, bound to the
+     * node and touched so that it is faulted in locally; otherwise it comes from the heap
+     * @param size
+     * @param mapped set to whether the stack was mapped, needed to release it
+     * @return the lowest address of the stack
+     * @throws std::bad_alloc on failure
+     */
+    static char *allocate(size_t size, bool &mapped);
+
+    /**
+     * free a stack returned by allocate
+     * @param stack
+     * @param size the size it was allocated with
+     * @param mapped the value allocate returned in mapped
+     */
+    static void release(char *stack, size_t size, bool mapped);
+
+    /**
+     * bind memory mapped on its own pages to the node set with setNode and touch every page, so
+     * that it is faulted in locally. Does nothing while placement is off
+     * @param memory page aligned
+     * @param size
+     */
+    static void placeLocal(void *memory, size_t size);
+
+    /**
+     * set the node new stacks are placed on, stacks already allocated stay where they are
+     * @param node the NUMA node, -1 to go back to heap allocation
+     */
+    static void setNode(int node);
+
+    /**
+     *
+     * @return the node stacks are placed on, -1 if placement is off
+     */
+    static int getNode();
+
+    /**
+     * @param paint whether stacks allocated from now on are filled with STACK_PAINT, so that
+     * the deepest point they were used to can be found later
+     */
+    static void setPaint(bool paint);
+
+    /**
+     *
+     * @return whether new stacks are painted
+     */
+    static bool isPainting();
+
+    /**
+     * @param stack a stack allocated while painting was on
+     * @param size
+     * @return how many bytes, from the top, were ever written to
+     */
+    static size_t usedBytes(const char *stack, size_t size);
+};
+
+#endif //EX2_STACKALLOCATOR_H
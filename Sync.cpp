@@ -0,0 +1,244 @@
+//------------------includes--------------------
+#include "Scheduler.h"
+#include "Sync.h"
+
+extern Scheduler *manager;
+
+//--------------ERRORS----------------------
+#define SYNC_DEADLOCK_ERR "no thread is left to wake the waiting thread"
+#define RWLOCK_UNLOCK_ERR "the lock is not held by the thread"
+#define BARRIER_COUNT_ERR "illegal barrier count, or threads are waiting on the barrier"
+
+//--------------functions-------------------
+
+// block the current thread until another thread resumes it, called with SIGVTALRM blocked.
+// cancel takes the thread off object if it is killed while it waits
+static int blockSelf(void (*cancel)(void *, int), void *object)
+{
+    Thread *self = manager->getCurrentThread();
+    self->setWaitObject(cancel, object);
+    int ret = manager->blockThread(self->getId());
+    self->setWaitObject(nullptr, nullptr);
+    if (ret == FAILURE)
+    {
+        std::cerr << THREAD_LIB_ERR << SYNC_DEADLOCK_ERR << std::endl;
+        return FAILURE;
+    }
+    return 0;
+}
+
+// resume every thread in waiting and empty it
+static void resumeAll(std::bitset<MAX_THREAD_NUM> &waiting)
+{
+    if (waiting.none())
+    { return; }
+    for (int tid = 0; tid < MAX_THREAD_NUM; ++tid)
+    {
+        if (waiting.test(tid))
+        { manager->resumeThread(tid); }
+    }
+    waiting.reset();
+}
+
+// resume one waiting writer to compete with the readers, the others wait for the next unlock
+static void resumeWriter(uthread_rwlock_t *lock)
+{
+    if (lock->writersWaiting.none())
+    { return; }
+    for (int w = 0; w < MAX_THREAD_NUM; ++w)
+    {
+        if (lock->writersWaiting.test(w))
+        {
+            lock->writersWaiting.reset(w);
+            manager->resumeThread(w);
+            return;
+        }
+    }
+}
+
+// the writer gives the lock up and lets the waiting threads in
+static void writerLeave(uthread_rwlock_t *lock)
+{
+    lock->writer = -1;
+    lock->state.fetch_and(~RWLOCK_WRITER);
+    resumeAll(lock->readersWaiting);
+    resumeWriter(lock);
+}
+
+// a reader killed while waiting for the writer to leave
+static void readerCancel(void *object, int tid)
+{
+    static_cast<uthread_rwlock_t *>(object)->readersWaiting.reset(tid);
+}
+
+// a writer killed while waiting for the lock. One that was already resumed passes the lock on
+static void writerCancel(void *object, int tid)
+{
+    auto lock = static_cast<uthread_rwlock_t *>(object);
+    if (lock->writersWaiting.test(tid))
+    { lock->writersWaiting.reset(tid); }
+    else if ((lock->state.load() & RWLOCK_WRITER) == 0)
+    { resumeWriter(lock); }
+}
+
+// a writer killed while waiting for the readers inside to leave, it gives the lock up
+static void drainCancel(void *object, int tid)
+{
+    auto lock = static_cast<uthread_rwlock_t *>(object);
+    if (lock->drainWaiter == tid)
+    {
+        lock->drainWaiter = -1;
+        writerLeave(lock);
+    }
+}
+
+// a thread killed while waiting on the barrier no longer counts as arrived
+static void barrierCancel(void *object, int tid)
+{
+    auto barrier = static_cast<uthread_barrier_t *>(object);
+    if (barrier->waiting.test(tid))
+    {
+        barrier->waiting.reset(tid);
+        barrier->arrived--;
+    }
+}
+
+// a reader leaves; the last one out lets a draining writer in
+static void readerLeave(uthread_rwlock_t *lock)
+{
+    if (lock->state.fetch_sub(1) == (RWLOCK_WRITER | 1))
+    {
+        blockAlarm();
+        if (lock->drainWaiter != -1)
+        {
+            manager->resumeThread(lock->drainWaiter);
+        }
+        unblockAlarm();
+    }
+}
+
+int uthread_rwlock_rdlock(uthread_rwlock_t *lock)
+{
+    // fast path, no masking: in unless a writer holds the lock
+    if ((lock->state.fetch_add(1) & RWLOCK_WRITER) == 0)
+    { return 0; }
+    readerLeave(lock);
+
+    //block signal
+    blockAlarm();
+    int tid = manager->getCurrentTid();
+    while (lock->state.load() & RWLOCK_WRITER)
+    {
+        lock->readersWaiting.set(tid);
+        if (blockSelf(readerCancel, lock) == FAILURE)
+        {
+            lock->readersWaiting.reset(tid);
+            unblockAlarm();
+            return FAILURE;
+        }
+    }
+    lock->state.fetch_add(1);
+    //unblock signal
+    unblockAlarm();
+    return 0;
+}
+
+int uthread_rwlock_wrlock(uthread_rwlock_t *lock)
+{
+    //block signal
+    blockAlarm();
+    int tid = manager->getCurrentTid();
+    while (lock->state.load() & RWLOCK_WRITER)
+    {
+        lock->writersWaiting.set(tid);
+        if (blockSelf(writerCancel, lock) == FAILURE)
+        {
+            lock->writersWaiting.reset(tid);
+            unblockAlarm();
+            return FAILURE;
+        }
+    }
+    // new readers wait from here on, the readers inside are waited for
+    lock->state.fetch_or(RWLOCK_WRITER);
+    lock->writer = tid;
+    while (lock->state.load() != RWLOCK_WRITER)
+    {
+        lock->drainWaiter = tid;
+        if (blockSelf(drainCancel, lock) == FAILURE)
+        {
+            lock->drainWaiter = -1;
+            writerLeave(lock);
+            unblockAlarm();
+            return FAILURE;
+        }
+    }
+    lock->drainWaiter = -1;
+    //unblock signal
+    unblockAlarm();
+    return 0;
+}
+
+int uthread_rwlock_unlock(uthread_rwlock_t *lock)
+{
+    // no masking to tell a reader from the writer: only the writer sets writer to its own tid
+    if (lock->writer == manager->getCurrentTid())
+    {
+        //block signal
+        blockAlarm();
+        writerLeave(lock);
+        //unblock signal
+        unblockAlarm();
+        return 0;
+    }
+
+    if ((lock->state.load() & ~RWLOCK_WRITER) == 0)
+    {
+        std::cerr << THREAD_LIB_ERR << RWLOCK_UNLOCK_ERR << std::endl;
+        return FAILURE;
+    }
+    readerLeave(lock);
+    return 0;
+}
+
+int uthread_barrier_init(uthread_barrier_t *barrier, int count)
+{
+    if (count < 1 || count > MAX_THREAD_NUM || barrier->arrived != 0)
+    {
+        std::cerr << THREAD_LIB_ERR << BARRIER_COUNT_ERR << std::endl;
+        return FAILURE;
+    }
+    barrier->count = count;
+    return 0;
+}
+
+int uthread_barrier_wait(uthread_barrier_t *barrier)
+{
+    //block signal
+    blockAlarm();
+    if (++barrier->arrived == barrier->count)
+    {
+        barrier->arrived = 0;
+        barrier->generation++;
+        resumeAll(barrier->waiting);
+        //unblock signal
+        unblockAlarm();
+        return BARRIER_SERIAL_THREAD;
+    }
+
+    int tid = manager->getCurrentTid();
+    int generation = barrier->generation;
+    while (barrier->generation == generation)
+    {
+        barrier->waiting.set(tid);
+        if (blockSelf(barrierCancel, barrier) == FAILURE)
+        {
+            barrier->waiting.reset(tid);
+            barrier->arrived--;
+            unblockAlarm();
+            return FAILURE;
+        }
+    }
+    //unblock signal
+    unblockAlarm();
+    return 0;
+}
@@ -0,0 +1,106 @@
+//
+// Reader-writer lock and barrier for uthreads. Threads that have to wait are BLOCKED in the
+// scheduler until they are let through, nothing spins.
+//
+
+#ifndef EX2_SYNC_H
+#define EX2_SYNC_H
+
+//------------------includes--------------------
+#include <atomic>
+#include <bitset>
+#include "uthreads.h"
+
+//------------------defines--------------------
+#define RWLOCK_WRITER (1 << 30) // set in the lock state while a writer holds the lock
+#define BARRIER_SERIAL_THREAD 1 // returned to the one thread that completes a barrier phase
+
+//---------------classes---------------------------
+
+/**
+ * A reader-writer lock. A reader takes the lock with one atomic increment as long as no writer
+ * holds it. A writer excludes new readers first and then waits for the readers inside to leave.
+ */
+class UthreadRWLock
+{
+public:
+    // readers inside, plus RWLOCK_WRITER while a writer holds the lock
+    std::atomic<int> state;
+    int writer;       // tid of the writer holding the lock, -1 if none
+    int drainWaiter;  // tid of the writer waiting for the readers inside to leave, -1 if none
+    std::bitset<MAX_THREAD_NUM> readersWaiting;
+    std::bitset<MAX_THREAD_NUM> writersWaiting;
+
+    UthreadRWLock() : state(0), writer(-1), drainWaiter(-1)
+    {}
+
+    UthreadRWLock(const UthreadRWLock &) = delete;
+
+    UthreadRWLock &operator=(const UthreadRWLock &) = delete;
+};
+
+/**
+ * A barrier for a fixed number of threads, reusable phase after phase.
+ */
+class UthreadBarrier
+{
+public:
+    int count;      // threads in a phase
+    int arrived;    // threads waiting in the current phase
+    int generation; // phases completed
+    std::bitset<MAX_THREAD_NUM> waiting;
+
+    UthreadBarrier() : count(0), arrived(0), generation(0)
+    {}
+
+    UthreadBarrier(const UthreadBarrier &) = delete;
+
+    UthreadBarrier &operator=(const UthreadBarrier &) = delete;
+};
+
+typedef UthreadRWLock uthread_rwlock_t;
+typedef UthreadBarrier uthread_barrier_t;
+
+//--------------functions-------------------
+
+/*
+ * Description: This function takes lock for reading. Any number of threads may hold the lock
+ * for reading at once. While a thread holds it for writing, or waits for the readers inside to
+ * leave, new readers are BLOCKED until the writer unlocks.
+ * Return value: On success, return 0. On failure (no other thread could ever let the thread
+ * through), return -1.
+*/
+int uthread_rwlock_rdlock(uthread_rwlock_t *lock);
+
+/*
+ * Description: This function takes lock for writing, BLOCKING the thread until no other thread
+ * holds the lock in any mode. New readers wait once the writer is waiting.
+ * Return value: On success, return 0. On failure (no other thread could ever let the thread
+ * through), return -1.
+*/
+int uthread_rwlock_wrlock(uthread_rwlock_t *lock);
+
+/*
+ * Description: This function releases lock, held for reading or for writing by the calling
+ * thread. When a writer unlocks, every waiting reader and one waiting writer are made READY.
+ * Return value: On success, return 0. On failure (the thread does not hold the lock), return -1.
+*/
+int uthread_rwlock_unlock(uthread_rwlock_t *lock);
+
+/*
+ * Description: This function sets the number of threads that have to call uthread_barrier_wait
+ * before any of them continues. It is an error to call this function with count < 1 or
+ * count > MAX_THREAD_NUM, or while threads wait on the barrier.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_barrier_init(uthread_barrier_t *barrier, int count);
+
+/*
+ * Description: This function BLOCKS the calling thread until count threads have called it, then
+ * all of them are made READY and the barrier starts its next phase.
+ * Return value: On success, return BARRIER_SERIAL_THREAD to the thread that completed the phase
+ * and 0 to the others. On failure (no other thread could ever complete the phase), return -1.
+*/
+int uthread_barrier_wait(uthread_barrier_t *barrier);
+
+#endif //EX2_SYNC_H
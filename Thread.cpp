@@ -1,17 +1,38 @@
 //------------------includes--------------------
 #include "Thread.h"
+#include "StackAllocator.h"
 
 extern sigjmp_buf _env[MAX_THREAD_NUM];
 
-Thread::Thread(int tid, void (*f)(void)) : _tid(tid),
-                                           _state(READY),
-                                           _quants(0),
-                                           _imWaiting(false),
-                                           _imWaitingForTP(nullptr)
+Thread::Thread(int tid, void (*f)(void), void (*entry)(void),
+               void (*closureRun)(void *, bool), size_t closureSize) : _tid(tid),
+                                                                       _state(READY),
+                                                                       _quants(0),
+                                                                       _quantumUsecs(0),
+                                                                       _runUsecs(0),
+                                                                       _priority(0),
+                                                                       _effectivePriority(0),
+                                                                       _group(0),
+                                                                       _imWaiting(false),
+                                                                       _imWaitingForTP(nullptr),
+                                                                       _stackHighWater(-1),
+                                                                       _fpuUser(false),
+                                                                       _mxcsr(DEFAULT_MXCSR),
+                                                                       _fpuCw(DEFAULT_FPU_CW),
+                                                                       _specific(),
+                                                                       _entry(f),
+                                                                       _closureRun(closureRun),
+                                                                       _closure(nullptr),
+                                                                       _arena(),
+                                                                       _waitCancel(nullptr),
+                                                                       _waitObject(nullptr)
 {
     try
     {
-        _tStack = new char[STACK_SIZE];
+        _tStackPainted = StackAllocator::isPainting();
+        _tStack = StackAllocator::allocate(STACK_SIZE, _tStackMapped);
+        if (_tStackPainted)
+        { _stackHighWater = 0; }
     }
     catch (...)
     {
@@ -20,12 +41,20 @@ Thread::Thread(int tid, void (*f)(void)) : _tid(tid),
     }
     address_t sp, pc;
 
-    sp = (address_t) _tStack + STACK_SIZE - sizeof(address_t);
-    pc = (address_t) f;
-    sigsetjmp(_env[tid], 1);
+    sp = (address_t) _tStack + STACK_SIZE;
+    if (closureRun != nullptr)
+    {
+        // the closure sits above the first frame, aligned like the stack top
+        sp -= (closureSize + CLOSURE_ALIGN - 1) & ~(address_t) (CLOSURE_ALIGN - 1);
+        _closure = (void *) sp;
+    }
+    sp -= sizeof(address_t);
+    pc = (address_t) entry;
+    // the kernel's signal mask is not kept in the env, the scheduler applies _sigMask
+    sigsetjmp(_env[tid], 0);
     _env[tid]->__jmpbuf[JB_SP] = translate_address(sp);
     _env[tid]->__jmpbuf[JB_PC] = translate_address(pc);
-    sigemptyset(&_env[tid]->__saved_mask); // should check for failure?
+    sigemptyset(&_sigMask);
 
 
 
@@ -33,12 +62,29 @@ Thread::Thread(int tid, void (*f)(void)) : _tid(tid),
 
 Thread::~Thread()
 {
+    if (_closureRun != nullptr)
+    {
+        _closureRun(_closure, false);
+    }
 
-    delete (_tStack);
+    StackAllocator::release(_tStack, STACK_SIZE, _tStackMapped);
     delayedByMeTids.clear();
 
 }
 
+void *Thread::operator new(size_t size)
+{
+    void *p = schedulerArena().allocate(size);
+    if (p == nullptr)
+    { throw std::bad_alloc(); }
+    return p;
+}
+
+void Thread::operator delete(void *p)
+{
+    schedulerArena().release(p);
+}
+
 sigjmp_buf *Thread::getEnv()
 {
     return &_env[_tid];
@@ -70,6 +116,16 @@ void Thread::incQuants()
     Thread::_quants++;
 }
 
+void Thread::addRunUsecs(long usecs)
+{
+    _runUsecs += usecs;
+}
+
+long Thread::getRunUsecs() const
+{
+    return _runUsecs;
+}
+
 void Thread::setImWaiting(bool syncState, Thread *tpSyncer)
 {
     Thread::_imWaiting = syncState;
@@ -125,7 +181,178 @@ Thread *Thread::get_imWaitingForTP() const
 }
 
 
-const std::vector<int> &Thread::getDelayedByMeTids() const
+const TidList &Thread::getDelayedByMeTids() const
 {
     return delayedByMeTids;
 }
+
+int Thread::getQuantum() const
+{
+    return _quantumUsecs;
+}
+
+void Thread::setQuantum(int quantumUsecs)
+{
+    _quantumUsecs = quantumUsecs;
+}
+
+int Thread::getPriority() const
+{
+    return _priority;
+}
+
+void Thread::setPriority(int priority)
+{
+    _priority = priority;
+}
+
+int Thread::getEffectivePriority() const
+{
+    return _effectivePriority;
+}
+
+void Thread::setEffectivePriority(int priority)
+{
+    _effectivePriority = priority;
+}
+
+void *Thread::getClosure() const
+{
+    return _closure;
+}
+
+void Thread::dropClosure()
+{
+    _closureRun = nullptr;
+}
+
+void Thread::runEntry()
+{
+    if (_closureRun != nullptr)
+    {
+        _closureRun(_closure, true);
+        _closureRun = nullptr; // the closure destroyed itself
+    }
+    else
+    {
+        _entry();
+    }
+}
+
+int Thread::getGroup() const
+{
+    return _group;
+}
+
+void Thread::setGroup(int group)
+{
+    _group = group;
+}
+
+void Thread::setFpuUser(bool fpuUser)
+{
+    _fpuUser = fpuUser;
+}
+
+bool Thread::isFpuUser() const
+{
+    return _fpuUser;
+}
+
+/*
+ * sigsetjmp keeps only the integer registers, and the vector registers are caller saved, so
+ * what can leak between threads on a voluntary switch is the control state. Reading it costs
+ * two instructions, so every thread is checked and only the ones that changed it pay for
+ * keeping their own state. The exception flags are left out of the check, any inexact float
+ * operation sets them. Preempted threads don't need this: the kernel keeps their whole
+ * extended state in the signal frame and restores it when the handler returns.
+ */
+void Thread::saveFpuState()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    asm volatile("stmxcsr %0" : "=m" (_mxcsr));
+    asm volatile("fnstcw %0" : "=m" (_fpuCw));
+    if (!_fpuUser && ((_mxcsr & ~MXCSR_FLAGS) != DEFAULT_MXCSR || _fpuCw != DEFAULT_FPU_CW))
+    {
+        _fpuUser = true;
+    }
+#endif
+}
+
+void Thread::restoreFpuState()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (_fpuUser)
+    {
+        asm volatile("ldmxcsr %0" : : "m" (_mxcsr));
+        asm volatile("fldcw %0" : : "m" (_fpuCw));
+        return;
+    }
+    // the previous thread may have left its own state behind
+    unsigned int mxcsr;
+    unsigned short fpuCw;
+    asm volatile("stmxcsr %0" : "=m" (mxcsr));
+    asm volatile("fnstcw %0" : "=m" (fpuCw));
+    if ((mxcsr & ~MXCSR_FLAGS) != DEFAULT_MXCSR || fpuCw != DEFAULT_FPU_CW)
+    {
+        mxcsr = DEFAULT_MXCSR;
+        fpuCw = DEFAULT_FPU_CW;
+        asm volatile("ldmxcsr %0" : : "m" (mxcsr));
+        asm volatile("fldcw %0" : : "m" (fpuCw));
+    }
+#endif
+}
+
+void Thread::updateStackHighWater()
+{
+    if (_tStackPainted)
+    {
+        _stackHighWater = (int) StackAllocator::usedBytes(_tStack, STACK_SIZE);
+    }
+}
+
+int Thread::getStackHighWater() const
+{
+    return _stackHighWater;
+}
+
+void *Thread::getSpecific(uthread_key_t key) const
+{
+    return _specific[key];
+}
+
+void Thread::setSpecific(uthread_key_t key, void *value)
+{
+    _specific[key] = value;
+}
+
+Arena &Thread::getArena()
+{
+    return _arena;
+}
+
+const sigset_t &Thread::getSigMask() const
+{
+    return _sigMask;
+}
+
+void Thread::setSigMask(const sigset_t &mask)
+{
+    _sigMask = mask;
+}
+
+void Thread::setWaitObject(void (*cancel)(void *, int), void *object)
+{
+    _waitCancel = cancel;
+    _waitObject = object;
+}
+
+void Thread::cancelWait()
+{
+    if (_waitCancel != nullptr)
+    {
+        _waitCancel(_waitObject, _tid);
+        _waitCancel = nullptr;
+        _waitObject = nullptr;
+    }
+}
@@ -50,7 +50,10 @@ inline address_t translate_address(address_t addr)
 #include <csetjmp>
 #include <signal.h>
 #include <iostream>
+#include <cstddef>
 #include "uthreads.h"
+#include "uthreads_ext.h"
+#include "Arena.h"
 
 //------------------defines--------------------
 #define READY 0
@@ -62,6 +65,12 @@ inline address_t translate_address(address_t addr)
 #define ALLOC_FAIL "memory allocation caused an issue"
 #define SYS_ERR_CODE 1
 #define FAILURE -1
+#define DEFAULT_MXCSR 0x1f80 // SSE control/status after reset
+#define MXCSR_FLAGS 0x3f // sticky exception flags of MXCSR, status rather than control
+#define DEFAULT_FPU_CW 0x037f // x87 control word after reset
+#define CLOSURE_ALIGN 16 // alignment of a closure kept on a thread's stack
+
+typedef std::vector<int, SchedulerAllocator<int> > TidList;
 //---------------class---------------------------
 
 
@@ -69,30 +78,76 @@ class Thread
 {
 private:
     int _tid, _state, _quants;
+    int _quantumUsecs;      // own quantum under adaptive quantums, 0 for the scheduler's
+    long _runUsecs;         // time the thread ran, partial quantums included
+    int _priority;          // as set by the user
+    int _effectivePriority; // raised to the highest priority of the threads synced on this one
+    int _group;             // thread group sharing the cpu by weight, 0 by default
     bool _imWaiting; //am i waiting for someone
     bool _imDelaying;
 
     Thread *_imWaitingForTP; // who am i waiting for
 
     char *_tStack;
+    bool _tStackMapped;
+    bool _tStackPainted;
+    int _stackHighWater;
 
     // list of IDs that are waiting for this
-    std::vector<int> delayedByMeTids;
+    TidList delayedByMeTids;
+
+    // floating point control state, kept across voluntary switches only for threads that use it
+    bool _fpuUser;
+    unsigned int _mxcsr;
+    unsigned short _fpuCw;
+
+    // thread specific storage, indexed by uthread_key_t
+    void *_specific[UTHREAD_KEYS_MAX];
+
+    // what the thread's entry runs: f, or closureRun on the closure at the top of the stack.
+    // closureRun(closure, false) only destroys the closure, for a thread killed before it ends
+    void (*_entry)(void);
+    void (*_closureRun)(void *, bool);
+    void *_closure;
 
+    // what uthread_alloc allocates from, used only by the thread itself
+    Arena _arena;
+
+    // signals the thread has blocked, the scheduler gives them to the kernel while it runs
+    sigset_t _sigMask;
+
+    // what the thread is blocked on outside the scheduler, and how to take it off there if the
+    // thread is killed while it waits
+    void (*_waitCancel)(void *, int);
+    void *_waitObject;
 
 public:
     /**
      * Constructor for Thread object
     * @param tid the id for the new thread
     * @param f
+    * @param entry where the thread starts, the scheduler's entry that calls runEntry
+    * @param closureRun if not nullptr, the thread runs closureRun(getClosure(), true) instead
+    * of f
+    * @param closureSize bytes kept for the closure at the top of the stack
     */
-    Thread(int tid, void (*f)(void));
+    Thread(int tid, void (*f)(void), void (*entry)(void),
+           void (*closureRun)(void *, bool) = nullptr, size_t closureSize = 0);
 
     /**
      * destructor
      */
     ~Thread();
 
+    /**
+     * Thread objects are allocated from the scheduler's arena
+     * @param size
+     * @return
+     */
+    static void *operator new(size_t size);
+
+    static void operator delete(void *p);
+
     /**
      * return an environment pointer of the thread
      * @return
@@ -128,6 +183,18 @@ public:
      */
     void incQuants();
 
+    /**
+     * charge the thread with time it ran
+     * @param usecs
+     */
+    void addRunUsecs(long usecs);
+
+    /**
+     *
+     * @return the time the thread ran until it last left the cpu, in micro-seconds
+     */
+    long getRunUsecs() const;
+
     /**
      * inform thread if it is waiting for another thread
      * @param syncState boolean parameter for the flag
@@ -169,7 +236,148 @@ public:
      *
      * @return pointer to the vector that im delaying.
      */
-    const std::vector<int> &getDelayedByMeTids() const;
+    const TidList &getDelayedByMeTids() const;
+
+    /**
+     *
+     * @return the thread's own quantum in micro-seconds, 0 if it uses the scheduler's quantum
+     */
+    int getQuantum() const;
+
+    /**
+     * @param quantumUsecs the thread's own quantum, 0 to use the scheduler's quantum
+     */
+    void setQuantum(int quantumUsecs);
+
+    /**
+     *
+     * @return the priority set for the thread
+     */
+    int getPriority() const;
+
+    /**
+     * @param priority the thread's own priority, higher runs first under the priority policy
+     */
+    void setPriority(int priority);
+
+    /**
+     *
+     * @return the priority the thread is scheduled with, including inherited priority
+     */
+    int getEffectivePriority() const;
+
+    /**
+     * @param priority the priority the thread is scheduled with
+     */
+    void setEffectivePriority(int priority);
+
+    /**
+     *
+     * @return the closure kept at the top of the stack, nullptr if the thread runs a plain f
+     */
+    void *getClosure() const;
+
+    /**
+     * forget the closure, which was never constructed, so it isn't run or destroyed
+     */
+    void dropClosure();
+
+    /**
+     * run the thread's function or closure, returns when it does
+     */
+    void runEntry();
+
+    /**
+     *
+     * @return the thread's group
+     */
+    int getGroup() const;
+
+    /**
+     * @param group
+     */
+    void setGroup(int group);
+
+    /**
+     * mark the thread as one that changes the floating point control state (rounding, flush to
+     * zero, exception masks) so that it is saved and restored when it switches voluntarily
+     * @param fpuUser
+     */
+    void setFpuUser(bool fpuUser);
+
+    /**
+     *
+     * @return whether the thread's floating point control state is saved on switches
+     */
+    bool isFpuUser() const;
+
+    /**
+     * save the floating point control state before switching out. A thread that was not marked
+     * but runs with a non default state is marked from now on
+     */
+    void saveFpuState();
+
+    /**
+     * load the floating point control state saved by saveFpuState if the thread uses it,
+     * otherwise make sure the default state is loaded. Called right before switching to the
+     * thread, so a thread that runs for the first time starts with the default state
+     */
+    void restoreFpuState();
+
+    /**
+     * measure how deep the thread's stack was used so far, if it was painted at allocation
+     */
+    void updateStackHighWater();
+
+    /**
+     *
+     * @return bytes of stack used as of the last updateStackHighWater, -1 if unknown
+     */
+    int getStackHighWater() const;
+
+    /**
+     *
+     * @param key
+     * @return the thread specific value stored under key
+     */
+    void *getSpecific(uthread_key_t key) const;
+
+    /**
+     * store a thread specific value under key
+     * @param key
+     * @param value
+     */
+    void setSpecific(uthread_key_t key, void *value);
+
+    /**
+     *
+     * @return the arena the thread's uthread_alloc calls are served from
+     */
+    Arena &getArena();
+
+    /**
+     *
+     * @return the signals the thread has blocked
+     */
+    const sigset_t &getSigMask() const;
+
+    /**
+     * replace the signals the thread has blocked, the scheduler applies them
+     * @param mask
+     */
+    void setSigMask(const sigset_t &mask);
+
+    /**
+     * record the object the thread is about to block on, nullptr once it stopped waiting
+     * @param cancel called with the object and the thread's id if the thread dies while waiting
+     * @param object
+     */
+    void setWaitObject(void (*cancel)(void *, int), void *object);
+
+    /**
+     * take the thread off the object it waits on, if any
+     */
+    void cancelWait();
 
 };
 
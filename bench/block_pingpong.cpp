@@ -0,0 +1,73 @@
+//
+// Block/resume ping-pong between two threads, with the timer re-armed on every switch and with
+// the lazy timer policy, and the run time each thread was charged.
+//
+// usage: block_pingpong [round trips]
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+
+//------------------defines--------------------
+#define DEFAULT_ROUND_TRIPS 200000
+#define QUANTUM_USECS 100000
+
+//---------------global variables----------------
+static long benchRoundTrips;
+static int pingTid, pongTid;
+
+//--------------functions-------------------
+static double nowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void ping()
+{
+    for (long i = 0; i < benchRoundTrips; ++i)
+    {
+        uthread_resume(pongTid);
+        uthread_block(pingTid);
+    }
+    uthread_terminate(pingTid);
+}
+
+static void pong()
+{
+    for (;;)
+    {
+        uthread_resume(pingTid);
+        uthread_block(pongTid);
+    }
+}
+
+static void run(bool lazy)
+{
+    uthread_set_lazy_timer(lazy);
+    pingTid = uthread_spawn(ping);
+    pongTid = uthread_spawn(pong);
+    uthread_block(pongTid); // pong starts once ping resumes it
+    double start = nowNs();
+    uthread_sync(pingTid);
+    double took = nowNs() - start;
+    printf("%-10s %.1f ns/round trip, pong ran %ld us\n", lazy ? "lazy:" : "re-armed:",
+           took / benchRoundTrips, uthread_get_run_usecs(pongTid));
+    uthread_terminate(pongTid);
+}
+
+int main(int argc, char *argv[])
+{
+    benchRoundTrips = argc > 1 ? atol(argv[1]) : DEFAULT_ROUND_TRIPS;
+    if (uthread_init(QUANTUM_USECS) == -1)
+    { return 1; }
+    run(false);
+    run(true);
+    uthread_terminate(0);
+    return 0;
+}
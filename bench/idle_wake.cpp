@@ -0,0 +1,94 @@
+//
+// Latency from uthread_post_resume on another pthread to the resumed uthread running, when the
+// library is parked idle, for a few spin counts.
+//
+// usage: idle_wake [wakeups]
+//
+
+//------------------includes--------------------
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+
+//------------------defines--------------------
+#define DEFAULT_WAKEUPS 2000
+#define SETTLE_USECS 200 // the poster waits this long so the waiter is parked for sure
+#define QUANTUM_USECS 10000
+
+//---------------global variables----------------
+static long benchWakeups;
+static int waiterTid;
+static std::atomic<bool> waiting(false);
+static std::atomic<double> postedNs(0);
+static std::vector<double> latencies;
+
+//--------------functions-------------------
+static double nowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void waiter()
+{
+    for (long i = 0; i < benchWakeups; ++i)
+    {
+        waiting = true;
+        uthread_block(waiterTid); // nothing else is ready, the library parks
+        latencies.push_back(nowNs() - postedNs);
+    }
+    uthread_terminate(waiterTid);
+}
+
+static void *poster(void *)
+{
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, nullptr);
+    for (long i = 0; i < benchWakeups; ++i)
+    {
+        while (!waiting)
+        {}
+        waiting = false;
+        usleep(SETTLE_USECS);
+        postedNs = nowNs();
+        uthread_post_resume(waiterTid);
+    }
+    return nullptr;
+}
+
+static void run(int spins)
+{
+    latencies.clear();
+    latencies.reserve(benchWakeups);
+    uthread_set_idle_parking(spins);
+    waiterTid = uthread_spawn(waiter);
+    pthread_t posterThread;
+    pthread_create(&posterThread, nullptr, poster, nullptr);
+    uthread_sync(waiterTid);
+    pthread_join(posterThread, nullptr);
+    std::sort(latencies.begin(), latencies.end());
+    printf("spins %-6d p50 %.1f us, p99 %.1f us\n", spins, latencies[latencies.size() / 2] / 1000,
+           latencies[latencies.size() * 99 / 100] / 1000);
+}
+
+int main(int argc, char *argv[])
+{
+    benchWakeups = argc > 1 ? atol(argv[1]) : DEFAULT_WAKEUPS;
+    if (uthread_init(QUANTUM_USECS) == -1)
+    { return 1; }
+    run(0);
+    run(1000);
+    run(100000);
+    uthread_terminate(0);
+    return 0;
+}
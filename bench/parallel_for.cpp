@@ -0,0 +1,74 @@
+//
+// Cost of uthread_parallel_for against a plain loop over the same range, with the helpers it
+// spawns and the steals they make, for several worker counts and grain sizes.
+//
+// usage: parallel_for [indices]
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+#include "Parallel.h"
+
+//------------------defines--------------------
+#define DEFAULT_INDICES 4000000
+#define LOOPS 20
+#define QUANTUM_USECS 1000
+
+//---------------global variables----------------
+static long benchIndices;
+static volatile long sink;
+
+//--------------functions-------------------
+static double nowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void plain()
+{
+    double start = nowNs();
+    for (int loop = 0; loop < LOOPS; ++loop)
+    {
+        for (long i = 0; i < benchIndices; ++i)
+        { sink = sink + i; }
+    }
+    double took = nowNs() - start;
+    printf("%-22s %.2f ns/index\n", "plain loop:", took / (LOOPS * benchIndices));
+}
+
+static void parallel(int workers, long grain)
+{
+    uthread_parallel_set_workers(workers);
+    double start = nowNs();
+    for (int loop = 0; loop < LOOPS; ++loop)
+    {
+        uthread_parallel_for(0, benchIndices, grain, [](long i)
+        { sink = sink + i; });
+    }
+    double took = nowNs() - start;
+    char label[32];
+    snprintf(label, sizeof(label), "%d workers, grain %ld:", workers, grain);
+    printf("%-22s %.2f ns/index, %.1f us/loop\n", label, took / (LOOPS * benchIndices),
+           took / LOOPS / 1000);
+}
+
+int main(int argc, char *argv[])
+{
+    benchIndices = argc > 1 ? atol(argv[1]) : DEFAULT_INDICES;
+    if (uthread_init(QUANTUM_USECS) == -1)
+    { return 1; }
+    plain();
+    for (int workers = 1; workers <= 4; workers *= 2)
+    {
+        parallel(workers, 0);
+        parallel(workers, 64);
+    }
+    uthread_terminate(0);
+    return 0;
+}
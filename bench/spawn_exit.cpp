@@ -0,0 +1,44 @@
+//
+// Cost of a thread's whole life: spawn, run, return from its function and be freed by the
+// next thread to run.
+//
+// usage: spawn_exit [threads]
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+
+//------------------defines--------------------
+#define DEFAULT_THREADS 20000
+#define QUANTUM_USECS 100000
+
+//--------------functions-------------------
+static double nowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void shortLived()
+{}
+
+int main(int argc, char *argv[])
+{
+    long threads = argc > 1 ? atol(argv[1]) : DEFAULT_THREADS;
+    if (uthread_init(QUANTUM_USECS) == -1)
+    { return 1; }
+    double start = nowNs();
+    for (long i = 0; i < threads; ++i)
+    {
+        uthread_sync(uthread_spawn(shortLived));
+    }
+    double took = nowNs() - start;
+    printf("%ld threads: %.1f ns per spawn, run and exit\n", threads, took / threads);
+    uthread_terminate(0);
+    return 0;
+}
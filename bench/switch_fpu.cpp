@@ -0,0 +1,74 @@
+//
+// Cost of a voluntary switch between threads with the default floating point control state,
+// and between threads that changed it and have it saved and loaded on every switch.
+//
+// usage: switch_fpu [switches]
+//
+
+//------------------includes--------------------
+#include <cfenv>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+
+//------------------defines--------------------
+#define DEFAULT_SWITCHES 1000000
+
+//---------------global variables----------------
+static volatile bool benchDone;
+static bool benchFpuUser;
+
+//--------------functions-------------------
+static double nowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void partner()
+{
+    if (benchFpuUser)
+    { fesetround(FE_UPWARD); }
+    while (!benchDone)
+    {
+        uthread_yield();
+    }
+    uthread_terminate(uthread_get_tid());
+}
+
+// ns per switch of the main thread ping-ponging with one partner
+static double run(long switches, bool fpuUser)
+{
+    benchDone = false;
+    benchFpuUser = fpuUser;
+    if (fpuUser)
+    { fesetround(FE_UPWARD); }
+    uthread_spawn(partner);
+    uthread_yield(); // the partner sets its state before timing starts
+    double start = nowNs();
+    for (long i = 0; i < switches / 2; ++i)
+    {
+        uthread_yield();
+    }
+    double took = nowNs() - start;
+    benchDone = true;
+    uthread_yield();
+    fesetround(FE_TONEAREST);
+    return took / switches;
+}
+
+int main(int argc, char *argv[])
+{
+    long switches = argc > 1 ? atol(argv[1]) : DEFAULT_SWITCHES;
+    if (uthread_init_cooperative(nullptr, 0) == -1)
+    { return 1; }
+    double plain = run(switches, false);
+    double fpu = run(switches, true);
+    printf("default fpu state: %.1f ns/switch\n", plain);
+    printf("own fpu state:     %.1f ns/switch\n", fpu);
+    uthread_terminate(0);
+    return 0;
+}
@@ -0,0 +1,78 @@
+//
+// Cost of a voluntary switch between threads with equal signal masks, which the scheduler
+// leaves alone, and between threads with different masks, which are given to the kernel on
+// every switch as all of them were when switches saved and restored the mask.
+//
+// usage: switch_sigmask [switches]
+//
+
+//------------------includes--------------------
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+
+//------------------defines--------------------
+#define DEFAULT_SWITCHES 1000000
+#define QUANTUM_USECS 1000000
+
+//---------------global variables----------------
+static volatile bool benchDone;
+static bool benchOwnMask;
+
+//--------------functions-------------------
+static double nowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void partner()
+{
+    if (benchOwnMask)
+    {
+        sigset_t usr1;
+        sigemptyset(&usr1);
+        sigaddset(&usr1, SIGUSR1);
+        uthread_sigmask(SIG_BLOCK, &usr1, nullptr);
+    }
+    while (!benchDone)
+    {
+        uthread_yield();
+    }
+    uthread_terminate(uthread_get_tid());
+}
+
+// ns per switch of the main thread ping-ponging with one partner
+static double run(long switches, bool ownMask)
+{
+    benchDone = false;
+    benchOwnMask = ownMask;
+    uthread_spawn(partner);
+    uthread_yield(); // the partner sets its mask before timing starts
+    double start = nowNs();
+    for (long i = 0; i < switches / 2; ++i)
+    {
+        uthread_yield();
+    }
+    double took = nowNs() - start;
+    benchDone = true;
+    uthread_yield();
+    return took / switches;
+}
+
+int main(int argc, char *argv[])
+{
+    long switches = argc > 1 ? atol(argv[1]) : DEFAULT_SWITCHES;
+    if (uthread_init(QUANTUM_USECS) == -1)
+    { return 1; }
+    double equal = run(switches, false);
+    double different = run(switches, true);
+    printf("equal masks:     %.1f ns/switch\n", equal);
+    printf("different masks: %.1f ns/switch\n", different);
+    uthread_terminate(0);
+    return 0;
+}
@@ -0,0 +1,115 @@
+//
+// Reader-writer lock and barrier costs: an uncontended read lock/unlock on the fast path, a
+// contended write lock handed between threads, and a barrier phase of several threads.
+//
+// usage: sync_rw_barrier [iterations]
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+#include "Sync.h"
+
+//------------------defines--------------------
+#define DEFAULT_ITERATIONS 200000
+#define BARRIER_THREADS 4
+#define QUANTUM_USECS 100000
+
+//---------------global variables----------------
+static long benchIterations;
+static uthread_rwlock_t lock;
+static uthread_barrier_t barrier;
+static int writersDone;
+
+//--------------functions-------------------
+static double nowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void writer()
+{
+    for (long i = 0; i < benchIterations; ++i)
+    {
+        uthread_rwlock_wrlock(&lock);
+        uthread_yield(); // the other writer blocks on the lock meanwhile
+        uthread_rwlock_unlock(&lock);
+    }
+    writersDone++;
+    uthread_block(uthread_get_tid()); // terminated by the main thread
+}
+
+static void phased()
+{
+    for (;;)
+    {
+        uthread_barrier_wait(&barrier);
+    }
+}
+
+static void readFastPath()
+{
+    double start = nowNs();
+    for (long i = 0; i < benchIterations; ++i)
+    {
+        uthread_rwlock_rdlock(&lock);
+        uthread_rwlock_unlock(&lock);
+    }
+    double took = nowNs() - start;
+    printf("%-10s %.1f ns/lock\n", "read:", took / benchIterations);
+}
+
+static void writeHandoff()
+{
+    double start = nowNs();
+    int first = uthread_spawn(writer);
+    int second = uthread_spawn(writer);
+    while (writersDone < 2)
+    {
+        uthread_yield();
+    }
+    double took = nowNs() - start;
+    uthread_terminate(first);
+    uthread_terminate(second);
+    printf("%-10s %.1f ns/lock\n", "write:", took / (2 * benchIterations));
+}
+
+static void barrierPhases()
+{
+    uthread_barrier_init(&barrier, BARRIER_THREADS);
+    int tids[BARRIER_THREADS - 1];
+    double start = nowNs();
+    // the main thread takes part in every phase, the others wait for it
+    for (int i = 0; i < BARRIER_THREADS - 1; ++i)
+    {
+        tids[i] = uthread_spawn(phased);
+    }
+    for (long i = 0; i < benchIterations; ++i)
+    {
+        uthread_barrier_wait(&barrier);
+    }
+    double took = nowNs() - start;
+    for (int i = 0; i < BARRIER_THREADS - 1; ++i)
+    {
+        uthread_terminate(tids[i]);
+    }
+    printf("%-10s %.1f ns/phase of %d threads\n", "barrier:", took / benchIterations,
+           BARRIER_THREADS);
+}
+
+int main(int argc, char *argv[])
+{
+    benchIterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    if (uthread_init(QUANTUM_USECS) == -1)
+    { return 1; }
+    readFastPath();
+    writeHandoff();
+    barrierPhases();
+    uthread_terminate(0);
+    return 0;
+}
@@ -0,0 +1,86 @@
+//
+// Cost of a cooperative yield with the library's scheduler and with a
+// BasicScheduler<BitmapReadySet<64>, NoTimerBackend, 64> instantiation.
+//
+// usage: template_yield [switches]
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+#include "BasicScheduler.h"
+
+//------------------defines--------------------
+#define DEFAULT_SWITCHES 1000000
+#define BITMAP_THREADS 64
+#define QUANTUM_USECS 100000
+
+//---------------types--------------------
+typedef BasicScheduler<BitmapReadySet<BITMAP_THREADS>, NoTimerBackend, BITMAP_THREADS>
+        BitmapScheduler;
+
+//---------------global variables----------------
+static BitmapScheduler *bitmapScheduler;
+
+//--------------functions-------------------
+static double nowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void bitmapPartner()
+{
+    for (;;)
+    {
+        bitmapScheduler->yieldThread();
+    }
+}
+
+static void libraryPartner()
+{
+    for (;;)
+    {
+        uthread_yield();
+    }
+}
+
+// the instantiation runs first and is left behind, the library takes over the jump buffers
+static double bitmapRun(long switches)
+{
+    bitmapScheduler = new BitmapScheduler(QUANTUM_USECS, false);
+    bitmapScheduler->createNewThread(bitmapPartner);
+    double start = nowNs();
+    for (long i = 0; i < switches / 2; ++i)
+    {
+        bitmapScheduler->yieldThread();
+    }
+    return (nowNs() - start) / switches;
+}
+
+static double libraryRun(long switches)
+{
+    uthread_init_cooperative(nullptr, 0);
+    uthread_spawn(libraryPartner);
+    double start = nowNs();
+    for (long i = 0; i < switches / 2; ++i)
+    {
+        uthread_yield();
+    }
+    return (nowNs() - start) / switches;
+}
+
+int main(int argc, char *argv[])
+{
+    long switches = argc > 1 ? atol(argv[1]) : DEFAULT_SWITCHES;
+    double bitmap = bitmapRun(switches);
+    double library = libraryRun(switches);
+    printf("bitmap/no timer: %.1f ns/switch\n", bitmap);
+    printf("library, cooperative: %.1f ns/switch\n", library);
+    uthread_terminate(0);
+    return 0;
+}
@@ -0,0 +1,68 @@
+//
+// A producer allocates blocks that a consumer frees, one at a time. The freed blocks have to
+// find their way back to the producer, or memory grows with every handoff.
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <unistd.h>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+
+//------------------defines--------------------
+#define HANDOFFS 200000
+#define BLOCK_SIZE 64
+#define MAX_GROWTH_KB 2048 // a leak of every block would be over 12 MB
+
+//---------------global variables----------------
+static void *slot;
+static volatile bool producing = true;
+
+//--------------functions-------------------
+// resident set size in kB
+static long residentKb()
+{
+    long pages = 0, resident = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm == nullptr)
+    { return 0; }
+    if (fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+    { resident = 0; }
+    fclose(statm);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void producer()
+{
+    for (long i = 0; i < HANDOFFS; ++i)
+    {
+        slot = uthread_alloc(BLOCK_SIZE);
+        uthread_yield();
+    }
+    producing = false;
+}
+
+static void consumer()
+{
+    while (producing)
+    {
+        uthread_free(slot);
+        slot = nullptr;
+        uthread_yield();
+    }
+}
+
+int main()
+{
+    uthread_init_cooperative(nullptr, 0);
+    long before = residentKb();
+    int producerTid = uthread_spawn(producer);
+    uthread_spawn(consumer);
+    uthread_sync(producerTid);
+    long growth = residentKb() - before;
+    bool ok = growth < MAX_GROWTH_KB;
+    if (!ok)
+    { fprintf(stderr, "arena_handoff_test: memory grew by %ld kB\n", growth); }
+    printf("arena_handoff_test: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+//
+// Captures a block/resume ping-pong and replays it: every captured call is replayed.
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+#include "Capture.h"
+#include "Replay.h"
+
+//------------------defines--------------------
+#define CAPTURE_PATH "/tmp/uthreads_capture_replay_test.cap"
+#define ROUND_TRIPS 1000
+#define QUANTUM_USECS 100000
+
+//---------------global variables----------------
+static int pingTid, pongTid;
+
+//--------------functions-------------------
+static bool check(bool ok, const char *what)
+{
+    if (!ok)
+    { fprintf(stderr, "capture_replay_test: %s\n", what); }
+    return ok;
+}
+
+static void ping()
+{
+    for (int i = 0; i < ROUND_TRIPS; ++i)
+    {
+        uthread_resume(pongTid);
+        uthread_block(pingTid);
+    }
+}
+
+static void pong()
+{
+    for (;;)
+    {
+        uthread_resume(pingTid);
+        uthread_block(pongTid);
+    }
+}
+
+int main()
+{
+    uthread_init(QUANTUM_USECS);
+    bool ok = check(uthread_capture_start(CAPTURE_PATH) == 0, "capture did not start");
+    pingTid = uthread_spawn(ping);
+    pongTid = uthread_spawn(pong);
+    uthread_block(pongTid); // pong starts once ping resumes it
+    uthread_sync(pingTid);
+    uthread_terminate(pongTid);
+    ok &= check(uthread_capture_stop() == 0, "capture did not stop");
+
+    CaptureHeader header;
+    std::vector<CaptureRecord> records;
+    ok &= check(captureRead(CAPTURE_PATH, header, records) == 0, "capture can't be read");
+    ok &= check(records.size() > 4 * ROUND_TRIPS, "calls missing from the capture");
+
+    uthread_replay_report_t report;
+    ok &= check(uthread_replay(CAPTURE_PATH, &report) == 0, "replay failed");
+    ok &= check(report.calls == (long) records.size(), "not every captured call was replayed");
+    unlink(CAPTURE_PATH);
+
+    printf("capture_replay_test: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+//
+// Starts the introspection server and reads a snapshot through a local client.
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+
+//------------------defines--------------------
+#define SOCKET_PATH "/tmp/uthreads_introspect_test.sock"
+#define QUANTUM_USECS 1000
+
+//--------------functions-------------------
+static void spinner()
+{
+    for (;;)
+    {}
+}
+
+static void blocker()
+{
+    uthread_block(uthread_get_tid());
+}
+
+// connect to the server and read the whole reply, on a pthread of its own
+static void *clientMain(void *out)
+{
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, nullptr);
+    std::string &json = *static_cast<std::string *>(out);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, SOCKET_PATH);
+    if (fd < 0 || connect(fd, (sockaddr *) &addr, sizeof(addr)) < 0)
+    {
+        return nullptr;
+    }
+    char buf[512];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+    {
+        json.append(buf, n);
+    }
+    close(fd);
+    return nullptr;
+}
+
+// the snapshot is published by the uthreads, so they keep running while the client waits
+static std::string readSnapshot()
+{
+    std::string json;
+    pthread_t client;
+    pthread_create(&client, nullptr, clientMain, &json);
+    while (pthread_tryjoin_np(client, nullptr) != 0)
+    {}
+    return json;
+}
+
+static bool check(bool ok, const char *what)
+{
+    if (!ok)
+    { fprintf(stderr, "introspect_test: %s\n", what); }
+    return ok;
+}
+
+int main()
+{
+    uthread_init(QUANTUM_USECS);
+    bool ok = check(uthread_introspect_start(SOCKET_PATH) == 0, "server did not start");
+    int spinnerTid = uthread_spawn(spinner);
+    int blockerTid = uthread_spawn(blocker);
+    while (uthread_get_quantums(blockerTid) == 0)
+    {}
+
+    std::string json = readSnapshot();
+    char entry[64];
+    ok &= check(json.find("\"current_tid\":") != std::string::npos, "no current thread");
+    snprintf(entry, sizeof(entry), "{\"tid\":%d,\"state\":\"READY\"", spinnerTid);
+    bool spinnerSeen = json.find(entry) != std::string::npos;
+    snprintf(entry, sizeof(entry), "{\"tid\":%d,\"state\":\"RUNNING\"", spinnerTid);
+    spinnerSeen |= json.find(entry) != std::string::npos;
+    ok &= check(spinnerSeen, "spinning thread missing");
+    snprintf(entry, sizeof(entry), "{\"tid\":%d,\"state\":\"BLOCKED\"", blockerTid);
+    ok &= check(json.find(entry) != std::string::npos, "blocked thread missing");
+
+    // with the client gone the next snapshot is fresh again
+    int quantums = uthread_get_total_quantums();
+    while (uthread_get_total_quantums() < quantums + 2)
+    {}
+    json = readSnapshot();
+    ok &= check(json.find("\"total_quantums\":") != std::string::npos, "second read failed");
+    int seen = -1;
+    sscanf(json.c_str(), "{\"total_quantums\":%d", &seen);
+    ok &= check(seen >= quantums + 2, "second snapshot is stale");
+
+    uthread_introspect_stop();
+    ok &= check(access(SOCKET_PATH, F_OK) != 0, "socket left behind");
+    printf("introspect_test: %s\n", ok ? "ok" : "FAILED");
+    // only the main thread is left, the exit status is the result
+    uthread_terminate(spinnerTid);
+    uthread_terminate(blockerTid);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+//
+// uthread_parallel_for and uthread_parallel_reduce cover every index exactly once for a grain
+// chosen by the library and a small one, with one worker and with several, and a loop whose
+// helper is terminated reports it.
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+#include "Parallel.h"
+
+//------------------defines--------------------
+#define INDICES 100000L
+#define SMALL_GRAIN 7
+#define QUANTUM_USECS 200
+#define KILL_INDICES 2000000L
+#define KILL_GRAIN 1000
+#define FIRST_HELPER_TID 2 // the killer takes tid 1, the helpers come after it
+
+//---------------global variables----------------
+static volatile bool loopStarted;
+
+//--------------functions-------------------
+static bool check(bool ok, const char *what, int workers, long grain)
+{
+    if (!ok)
+    { fprintf(stderr, "parallel_test: %s (%d workers, grain %ld)\n", what, workers, grain); }
+    return ok;
+}
+
+static bool checkLoops(int workers, long grain)
+{
+    uthread_parallel_set_workers(workers);
+    std::vector<int> hits(INDICES);
+    int ret = uthread_parallel_for(0L, INDICES, grain, [&](long i)
+    { hits[i]++; });
+    bool ok = check(ret == 0, "parallel_for failed", workers, grain);
+    bool once = true;
+    for (int h : hits)
+    { once &= h == 1; }
+    ok &= check(once, "an index was not run exactly once", workers, grain);
+
+    long sum = -1;
+    ret = uthread_parallel_reduce(0L, INDICES, grain, 0L, [](long i)
+    { return i; }, std::plus<long>(), &sum);
+    ok &= check(ret == 0, "parallel_reduce failed", workers, grain);
+    ok &= check(sum == INDICES * (INDICES - 1) / 2, "wrong reduction", workers, grain);
+    return ok;
+}
+
+// terminates helpers once the loop runs
+static void killer()
+{
+    while (!loopStarted)
+    { uthread_yield(); }
+    for (int tid = FIRST_HELPER_TID; tid < FIRST_HELPER_TID + 3; ++tid)
+    { uthread_terminate(tid); }
+}
+
+int main()
+{
+    uthread_init(QUANTUM_USECS);
+    bool ok = true;
+    for (int workers = 1; workers <= 4; workers *= 4)
+    {
+        ok &= checkLoops(workers, 0);
+        ok &= checkLoops(workers, SMALL_GRAIN);
+    }
+
+    uthread_parallel_set_workers(4);
+    loopStarted = false;
+    uthread_spawn(killer);
+    int ret = uthread_parallel_for(0L, KILL_INDICES, KILL_GRAIN, [](long)
+    {
+        loopStarted = true;
+        for (volatile int spin = 0; spin < 20; ++spin)
+        {}
+    });
+    ok &= check(ret == -1, "loop with a terminated helper succeeded", 4, KILL_GRAIN);
+
+    printf("parallel_test: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
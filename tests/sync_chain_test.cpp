@@ -0,0 +1,98 @@
+//
+// Sync chains: a sync that would close a cycle is rejected, and under the priority policy a
+// thread inherits the priority of the threads synced on it, along the whole chain.
+//
+
+//------------------includes--------------------
+#include <cstdio>
+#include <cstring>
+#include "uthreads.h"
+#include "uthreads_ext.h"
+
+//------------------defines--------------------
+#define HIGH_PRIORITY 10
+#define MEDIUM_PRIORITY 5
+
+//---------------global variables----------------
+static int tidA, tidB;
+static int cycleResult;
+static int lowTid, middleTid;
+static char order[16];
+static int ordered;
+
+//--------------functions-------------------
+static bool check(bool ok, const char *what)
+{
+    if (!ok)
+    { fprintf(stderr, "sync_chain_test: %s\n", what); }
+    return ok;
+}
+
+static void logRun(char c)
+{
+    order[ordered++] = c;
+}
+
+static void syncsOnB()
+{
+    uthread_sync(tidB);
+}
+
+// A waits for us by now, waiting for A would leave neither to ever run
+static void syncsOnA()
+{
+    cycleResult = uthread_sync(tidA);
+}
+
+static void low()
+{
+    logRun('L');
+    uthread_yield(); // still the highest, through the chain
+    logRun('l');
+}
+
+static void middle()
+{
+    uthread_sync(lowTid);
+    logRun('M');
+}
+
+static void high()
+{
+    uthread_sync(middleTid);
+    logRun('H');
+}
+
+static void medium()
+{
+    logRun('X');
+}
+
+int main()
+{
+    uthread_init_cooperative(nullptr, 0);
+    bool ok = true;
+
+    tidA = uthread_spawn(syncsOnB);
+    tidB = uthread_spawn(syncsOnA);
+    while (uthread_get_quantums(tidB) == 0)
+    { uthread_yield(); }
+    ok &= check(cycleResult == -1, "sync closing a cycle was not rejected");
+    uthread_yield(); // A goes on once B is done
+    ok &= check(uthread_resume(tidA) == -1, "A still waits after B terminated");
+
+    // high waits for middle, which waits for low: low runs before medium, at high's priority
+    uthread_set_priority_policy(1);
+    lowTid = uthread_spawn(low);
+    middleTid = uthread_spawn(middle);
+    int highTid = uthread_spawn(high);
+    int mediumTid = uthread_spawn(medium);
+    uthread_set_priority(highTid, HIGH_PRIORITY);
+    uthread_set_priority(mediumTid, MEDIUM_PRIORITY);
+    while (ordered < 5)
+    { uthread_yield(); }
+    ok &= check(strcmp(order, "LlMHX") == 0, "priority was not inherited along the chain");
+
+    printf("sync_chain_test: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,324 @@
+//
+// Extensions to the uthreads library interface declared in uthreads.h.
+//
+
+#ifndef EX2_UTHREADS_EXT_H
+#define EX2_UTHREADS_EXT_H
+
+//------------------includes--------------------
+#include <cstddef>
+#include <signal.h>
+
+//------------------defines--------------------
+#define UTHREAD_KEYS_MAX 16 // number of thread specific storage slots in every thread
+#define UTHREAD_GROUPS_MAX 16 // number of thread groups, including the default group 0
+
+typedef int uthread_key_t;
+
+/*
+ * Description: This function initializes the thread library in cooperative mode: no timer is
+ * armed and no signal is used, a thread keeps running until it yields, blocks, syncs or
+ * terminates. Each of these starts a new quantum. If switch_log is not nullptr the id of
+ * every thread that gets the cpu is recorded in it, in order, up to log_size entries.
+ * Like uthread_init it is called once, instead of uthread_init.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_init_cooperative(int *switch_log, int log_size);
+
+/*
+ * Description: This function initializes the thread library in cooperative mode and replays a
+ * switch order recorded by uthread_init_cooperative: every scheduling decision runs the next
+ * recorded thread if it is READY, otherwise the head of the READY list.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_init_replay(const int *switch_log, int log_size);
+
+/*
+ * Description: This function moves the RUNNING thread to the end of the READY threads list
+ * and makes a scheduling decision, starting a new quantum. In cooperative mode this is how a
+ * thread lets the others run.
+ * Return value: On success, return 0.
+*/
+int uthread_yield();
+
+/*
+ * Description: This function returns the number of switches recorded in the switch log given
+ * to uthread_init_cooperative.
+ * Return value: The number of recorded entries.
+*/
+int uthread_get_switch_count();
+
+/*
+ * Description: This function creates n new threads, all with the entry point f, as if
+ * uthread_spawn(f) was called n times, but the library is locked once, the ids are found in a
+ * single scan and the whole batch is appended to the end of the READY threads list at once.
+ * The call fails without creating any thread if it would exceed MAX_THREAD_NUM.
+ * Return value: On success, return 0 and write the ids of the new threads, in READY order,
+ * to tids_out. On failure, return -1.
+*/
+int uthread_spawn_many(void (*f)(void), int n, int *tids_out);
+
+/*
+ * Description: This function resumes the n threads whose ids are in tids, as if uthread_resume
+ * was called on each of them in order, appending the threads that become READY to the READY
+ * list in one operation. If one of the ids does not exist it is considered an error and no
+ * thread is resumed.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_resume_many(const int *tids, int n);
+
+/*
+ * Description: This function creates a key for thread specific storage, visible to all threads,
+ * whose value in every thread is initially nullptr. When a thread terminates with a non null
+ * value for the key, destructor (if not nullptr) is called with that value.
+ * Return value: On success, return 0 and store the new key in *key. On failure (key is
+ * nullptr, or all UTHREAD_KEYS_MAX keys are in use), return -1.
+*/
+int uthread_key_create(uthread_key_t *key, void (*destructor)(void *));
+
+/*
+ * Description: This function returns the value the calling thread associated with key.
+ * Return value: The value, or nullptr if none was set or key was not created.
+*/
+void *uthread_getspecific(uthread_key_t key);
+
+/*
+ * Description: This function associates value with key for the calling thread.
+ * Return value: On success, return 0. On failure (key was not created), return -1.
+*/
+int uthread_setspecific(uthread_key_t key, const void *value);
+
+/*
+ * Description: This function pins the process, and so every uthread, to the n cores listed in
+ * cores and makes the library allocate the stacks and control blocks of threads spawned from
+ * now on, and the memory uthread_alloc maps from now on, on the NUMA node of the core it runs
+ * on, bound to the node where the kernel supports it and faulted in locally either way. On a
+ * machine with a single node this only pins.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_set_affinity(const int *cores, int n);
+
+/*
+ * Description: This function marks the thread with ID tid as one that changes the floating point
+ * control state (SSE MXCSR and x87 control word: rounding mode, flush to zero, exception masks),
+ * which is then saved and restored whenever the thread yields, blocks or syncs. A thread that
+ * switches out with a non default control state is marked automatically. The vector registers
+ * themselves never need this: they are caller saved across library calls, and the kernel keeps
+ * them for a preempted thread.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_set_fpu(int tid, int fpu_user);
+
+/*
+ * Description: This function sets the priority of the thread with ID tid. Priorities only
+ * matter under the priority policy, where a thread also inherits the highest priority of the
+ * threads synced with it. All threads start with priority 0.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_set_priority(int tid, int priority);
+
+/*
+ * Description: This function turns the priority policy on or off. Under the priority policy
+ * every scheduling decision runs the READY thread with the highest (inherited) priority, the
+ * one closest to the head of the READY list among equals; otherwise the head of the list runs.
+ * Return value: On success, return 0.
+*/
+int uthread_set_priority_policy(int on);
+
+/*
+ * Description: This function starts serving snapshots of the library on a Unix domain socket
+ * at socket_path, from a dedicated kernel thread. Every connection receives one JSON object
+ * with the total quantums, the running thread, the READY list length and, per thread, its
+ * state, quantums, the thread it is synced with, its priority and the deepest its stack was
+ * used (known for threads spawned after this call, -1 otherwise), then is closed. The threads
+ * never wait for the server: a connection asks for a copy, which is published at the end of the
+ * next library call or switch, and gets the previous copy if none comes within
+ * INTROSPECT_WAIT_MS milliseconds. With no connection waiting nothing is copied.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_introspect_start(const char *socket_path);
+
+/*
+ * Description: This function stops the server started by uthread_introspect_start and removes
+ * its socket.
+ * Return value: On success, return 0.
+*/
+int uthread_introspect_stop();
+
+/*
+ * Description: This function changes the length of a quantum in micro-seconds, for all threads,
+ * without reinitializing the library. The timer of the RUNNING thread's current quantum is
+ * restarted with the new length. Under adaptive quantums this is the length every thread starts
+ * again from. It is an error to call this function with non-positive quantum_usecs.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_set_quantum(int quantum_usecs);
+
+/*
+ * Description: This function turns adaptive quantums on: a thread whose quantum runs out gets a
+ * quantum twice as long the next time it runs, up to max_usecs, and a thread that yields,
+ * blocks or syncs before its quantum ends gets one half as long, down to min_usecs. CPU bound
+ * threads so switch less often while threads that wait a lot are switched to sooner. Every
+ * thread starts from the library's quantum. Calling it with min_usecs == max_usecs == 0 turns
+ * adaptive quantums off. It is an error if 0 < min_usecs <= max_usecs does not hold otherwise.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_set_adaptive_quantum(int min_usecs, int max_usecs);
+
+/*
+ * Description: This function sets how the quantum timer is handled when a thread gives up the
+ * CPU by yielding, blocking or syncing. By default the next thread starts a full quantum, which
+ * re-arms the timer. With lazy != 0 the next thread finishes the quantum that was running, and
+ * the timer is only re-armed when the next thread's quantum has a different length (adaptive
+ * quantums). Preemption never re-arms the timer unless the length changes.
+ * Return value: On success, return 0.
+*/
+int uthread_set_lazy_timer(int lazy);
+
+/*
+ * Description: This function returns how long the thread with ID tid ran, in micro-seconds.
+ * A thread that gives up the CPU before its quantum ends is only charged the part it used,
+ * and the RUNNING thread's count includes its current quantum so far. It is an error if no
+ * thread with ID tid exists.
+ * Return value: On success, return the run time of the thread with ID tid. On failure, return
+ * -1.
+*/
+long uthread_get_run_usecs(int tid);
+
+/*
+ * Description: This function creates a thread group. Groups share the CPU by weight and not by
+ * their number of threads: for every quantum given to the threads of a group of weight 1, the
+ * threads of a group of weight w get w quantums, as long as both groups have ready threads. A
+ * thread that gives up the CPU early is only charged the part of the quantum it used, so groups
+ * that block often are not held back. The threads within a group take turns as usual. Threads
+ * not spawned into a group, including the main thread, are in group 0 whose weight is 1. It is
+ * an error to call this function with a non-positive weight.
+ * Return value: On success, return the id of the new group. On failure (bad weight, or
+ * UTHREAD_GROUPS_MAX groups exist), return -1.
+*/
+int uthread_group_create(int weight);
+
+/*
+ * Description: This function creates a new thread, like uthread_spawn, in group gid. It is an
+ * error if no group with id gid exists.
+ * Return value: On success, return the ID of the created thread. On failure, return -1.
+*/
+int uthread_spawn_in_group(void (*f)(void), int gid);
+
+/*
+ * Description: This function changes the weight of group gid, group 0 included. It is an error
+ * if no group with id gid exists or if weight is non-positive.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_group_set_weight(int gid, int weight);
+
+/*
+ * Description: This function returns the number of quantums the threads of group gid have
+ * started since the library was initialized, including those of threads that terminated. It is
+ * an error if no group with id gid exists.
+ * Return value: On success, return the number of quantums of group gid. On failure, return -1.
+*/
+int uthread_group_get_quantums(int gid);
+
+/*
+ * Description: This function returns the run time charged to the threads of group gid since
+ * the group was created, in micro-seconds, counted as by uthread_get_run_usecs and including
+ * threads that terminated. Unlike uthread_group_get_quantums it tells how much CPU the group
+ * used, however short its quantums were. It is an error if no group with id gid exists.
+ * Return value: On success, return the run time of group gid. On failure, return -1.
+*/
+long uthread_group_get_run_usecs(int gid);
+
+/*
+ * Description: This function asks the library to resume the thread with ID tid, as
+ * uthread_resume does. Unlike every other library function it may be called from any pthread
+ * and from signal handlers: the request is posted without locking and carried out at the next
+ * switch, or right away if the library is parked waiting for work (see
+ * uthread_set_idle_parking). Posts for a thread that does not exist by then are dropped.
+ * Return value: On success, return 0. On failure (tid out of range), return -1.
+*/
+int uthread_post_resume(int tid);
+
+/*
+ * Description: This function turns idle parking on (spins >= 0) or off (spins == -1, the
+ * default). With it on, a thread that blocks itself, syncs or terminates while no other thread
+ * is READY does not fail: it polls for posted resumes spins times and then sleeps in the kernel
+ * until uthread_post_resume is called, after which the resumed thread runs. The time parked is
+ * no thread's run time. It is an error to call this function with spins < -1.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_set_idle_parking(int spins);
+
+/*
+ * Description: This function allocates size bytes, 16 byte aligned, for the calling thread.
+ * Blocks of up to 2048 bytes come from the thread's own arena without locking or blocking
+ * signals, so the thread may be preempted at any point of the call. The block may be passed to
+ * uthread_free by any thread. It is an error to call this function before uthread_init.
+ * Return value: On success, return the block. On failure (no memory, or called before
+ * uthread_init), return nullptr.
+*/
+void *uthread_alloc(size_t size);
+
+/*
+ * Description: This function frees ptr, a block returned by uthread_alloc, into the calling
+ * thread's arena. Blocks a thread still caches when it terminates are handed to the other
+ * threads. Freeing nullptr, or freeing before uthread_init, does nothing.
+ * Return value: None.
+*/
+void uthread_free(void *ptr);
+
+/*
+ * Description: This function turns safe point preemption on (max_deferred >= 0) or off
+ * (max_deferred == -1, the default). With it on, library calls block no signals: when a quantum
+ * ends while the RUNNING thread is inside a library call, the switch is carried out as the call
+ * returns, and in between the thread can't be preempted. A thread outside the library is
+ * preempted at its next safe point (any library call, or uthread_checkpoint), or right from the
+ * signal handler once it ran max_deferred quantums past its own without reaching one. With
+ * max_deferred == 0 a thread outside the library is preempted right away, as with the mode off.
+ * It is an error to call this function with max_deferred < -1.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_set_safe_points(int max_deferred);
+
+/*
+ * Description: This function is a safe point: if the RUNNING thread's quantum is over and its
+ * preemption waits for a safe point (see uthread_set_safe_points), it is moved to the end of the
+ * READY threads list and the next thread runs. Otherwise it returns right away, without blocking
+ * signals, so long loops may call it often.
+ * Return value: On success, return 0.
+*/
+int uthread_checkpoint();
+
+/*
+ * Description: This function examines and changes the signal mask of the calling thread, as
+ * sigprocmask(2) does for a process: how is SIG_BLOCK, SIG_UNBLOCK or SIG_SETMASK, set is the
+ * signals to change (nullptr to only examine the mask) and oldset, if not nullptr, receives the
+ * mask before the change. Every thread has a mask of its own, a new thread starts with none
+ * blocked and the main thread with the mask the process had at uthread_init. The library gives
+ * a thread's mask to the kernel as it gets the cpu, changing only the signals it differs in from
+ * the thread before, so switching between threads with equal masks costs no system call.
+ * SIGVTALRM is the library's own and SIGKILL and SIGSTOP can't be blocked, these are never part
+ * of a thread's mask. It is an error to call this function with any other how.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_sigmask(int how, const sigset_t *set, sigset_t *oldset);
+
+/*
+ * Description: This function starts capturing the workload to a file at path: every spawn,
+ * terminate, block, resume, sync and yield, and every return from a thread function, is
+ * recorded with its time and the CPU time the calling thread ran since its previous call. Calls
+ * that fail are not recorded. The file is written as the capture goes and is complete once
+ * uthread_capture_stop is called or the process terminates through uthread_terminate(0).
+ * uthread_replay reproduces it. It is an error to call this function while a capture is running.
+ * Return value: On success, return 0. On failure, return -1.
+*/
+int uthread_capture_start(const char *path);
+
+/*
+ * Description: This function stops the running capture and closes its file.
+ * Return value: On success, return 0. On failure (no capture is running, or the file could not
+ * be written in full), return -1.
+*/
+int uthread_capture_stop();
+
+#endif //EX2_UTHREADS_EXT_H